@@ -0,0 +1,75 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "benchmark-stats.h"
+
+#include <algorithm>
+#include <time.h>
+
+namespace ns3 {
+
+BenchmarkStats::BenchmarkStats ()
+  : m_sorted (false)
+{
+}
+
+uint64_t
+BenchmarkStats::Now ()
+{
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t> (now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+uint64_t
+BenchmarkStats::GetClockOverhead ()
+{
+  const uint32_t calls = 10000;
+  uint64_t start = Now ();
+  for (uint32_t i = 0; i < calls; i++)
+    Now ();
+  return (Now () - start) / calls;
+}
+
+void
+BenchmarkStats::Reset (uint32_t count)
+{
+  m_samples.clear ();
+  m_samples.reserve (count);
+  m_sorted = false;
+}
+
+uint32_t
+BenchmarkStats::GetCount () const
+{
+  return m_samples.size ();
+}
+
+double
+BenchmarkStats::GetMean () const
+{
+  if (m_samples.empty ())
+    return 0;
+
+  double sum = 0;
+  for (std::vector<uint64_t>::const_iterator sample = m_samples.begin (); sample != m_samples.end (); sample++)
+    sum += *sample;
+  return sum / m_samples.size ();
+}
+
+uint64_t
+BenchmarkStats::GetPercentile (double quantile)
+{
+  if (m_samples.empty ())
+    return 0;
+
+  if (!m_sorted)
+    {
+      std::sort (m_samples.begin (), m_samples.end ());
+      m_sorted = true;
+    }
+
+  size_t index = static_cast<size_t> (quantile * (m_samples.size () - 1) + 0.5);
+  return m_samples[std::min (index, m_samples.size () - 1)];
+}
+
+} // namespace ns3
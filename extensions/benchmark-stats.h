@@ -0,0 +1,66 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef BENCHMARK_STATS_H
+#define BENCHMARK_STATS_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Latency samples of a microbenchmark, in nanoseconds
+ *
+ * Samples are kept in a preallocated vector, so that Record does not allocate while
+ * the benchmarked operation is measured.
+ */
+class BenchmarkStats
+{
+public:
+  BenchmarkStats ();
+
+  /**
+   * @brief Monotonic wall clock, in nanoseconds
+   */
+  static uint64_t
+  Now ();
+
+  /**
+   * @brief Cost of a Now () call, to be kept in mind for very short operations
+   */
+  static uint64_t
+  GetClockOverhead ();
+
+  /**
+   * @brief Drop all samples and reserve space for count new ones
+   */
+  void
+  Reset (uint32_t count);
+
+  inline void
+  Record (uint64_t nanoSeconds)
+  {
+    m_samples.push_back (nanoSeconds);
+    m_sorted = false;
+  }
+
+  uint32_t
+  GetCount () const;
+
+  double
+  GetMean () const;
+
+  /**
+   * @brief Sample at the given quantile (e.g., 0.99), 0 if there are no samples
+   */
+  uint64_t
+  GetPercentile (double quantile);
+
+private:
+  std::vector<uint64_t> m_samples;
+  bool m_sorted;
+};
+
+} // namespace ns3
+
+#endif // BENCHMARK_STATS_H
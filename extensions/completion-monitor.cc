@@ -0,0 +1,91 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "completion-monitor.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("CompletionMonitor");
+
+namespace ns3 {
+
+CompletionMonitor::CompletionMonitor ()
+  : m_expectedStops (0)
+  , m_stops (0)
+{
+}
+
+void
+CompletionMonitor::Start (Time duration, uint32_t expectedStops, Time quiescence, Time notBefore)
+{
+  m_duration = duration;
+  m_expectedStops = expectedStops;
+  m_stops = 0;
+  m_quiescence = quiescence;
+  m_notBefore = notBefore;
+  m_lastActivity = Simulator::Now ();
+  m_completion = duration;
+
+  m_check.Cancel ();
+  if (!m_quiescence.IsZero ())
+    m_check = Simulator::Schedule (std::max (m_quiescence, m_notBefore), &CompletionMonitor::CheckQuiescence, this);
+}
+
+void
+CompletionMonitor::NotifyStopped ()
+{
+  m_stops++;
+  if (m_expectedStops == 0 || m_stops < m_expectedStops)
+    return;
+
+  NS_LOG_DEBUG ("All " << m_stops << " consumers stopped at " << Simulator::Now ());
+  if (Simulator::Now () < m_notBefore)
+    {
+      m_check.Cancel ();
+      m_check = Simulator::Schedule (m_notBefore - Simulator::Now (), &CompletionMonitor::Complete, this);
+    }
+  else
+    Complete ();
+}
+
+void
+CompletionMonitor::NotifyActivity ()
+{
+  m_lastActivity = Simulator::Now ();
+}
+
+void
+CompletionMonitor::CheckQuiescence ()
+{
+  // Activity is only timestamped, the check is pushed back lazily
+  Time quiet = m_lastActivity + m_quiescence;
+  if (quiet > Simulator::Now ())
+    {
+      m_check = Simulator::Schedule (quiet - Simulator::Now (), &CompletionMonitor::CheckQuiescence, this);
+      return;
+    }
+
+  NS_LOG_DEBUG ("No activity since " << m_lastActivity << ", stopping at " << Simulator::Now ());
+  Complete ();
+}
+
+void
+CompletionMonitor::Complete ()
+{
+  if (Simulator::Now () >= m_duration)
+    return;
+
+  m_check.Cancel ();
+  m_completion = Simulator::Now ();
+  Simulator::Stop ();
+}
+
+Time
+CompletionMonitor::GetSkippedTime () const
+{
+  return m_duration - m_completion;
+}
+
+} // namespace ns3
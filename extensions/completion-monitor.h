@@ -0,0 +1,71 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef COMPLETION_MONITOR_H
+#define COMPLETION_MONITOR_H
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+namespace ns3 {
+
+/**
+ * @brief Stops the simulation once nothing recorded can change anymore
+ *
+ * The simulation is stopped as soon as either
+ * - all expected consumers have reported stopping (NotifyStopped), or
+ * - with a non-zero quiescence time, no activity (NotifyActivity) was seen for that long.
+ *
+ * but never before the time given to Start (e.g., when cache images are captured).
+ * The first condition is exact for consumers that stop on good content: a stopped
+ * consumer records nothing anymore.  Quiescence is a heuristic, later activity
+ * (e.g., after exclusions expire) would be lost.
+ */
+class CompletionMonitor
+{
+public:
+  CompletionMonitor ();
+
+  /**
+   * @brief Start monitoring a simulation scheduled to stop at duration
+   * @param expectedStops number of NotifyStopped calls completing the simulation, 0 for none
+   * @param quiescence time without activity completing the simulation, 0 to disable
+   * @param notBefore earliest time at which the simulation may be stopped
+   *
+   * Must be called for every simulation run, before Simulator::Run
+   */
+  void
+  Start (Time duration, uint32_t expectedStops, Time quiescence, Time notBefore);
+
+  void
+  NotifyStopped ();
+
+  void
+  NotifyActivity ();
+
+  /**
+   * @brief Simulated time between the early stop and duration, zero if the simulation ran to the end
+   */
+  Time
+  GetSkippedTime () const;
+
+private:
+  void
+  CheckQuiescence ();
+
+  void
+  Complete ();
+
+private:
+  Time m_duration;
+  uint32_t m_expectedStops;
+  uint32_t m_stops;
+  Time m_quiescence;
+  Time m_notBefore;
+  Time m_lastActivity;
+  Time m_completion;             ///< @brief time of the early stop, m_duration if none
+  EventId m_check;
+};
+
+} // namespace ns3
+
+#endif // COMPLETION_MONITOR_H
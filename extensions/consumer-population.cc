@@ -0,0 +1,480 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "consumer-population.h"
+#include "ranking-table.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+
+#include <cmath>
+#include <limits>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.ConsumerPopulation");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED (ConsumerPopulation);
+
+TypeId
+ConsumerPopulation::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::ConsumerPopulation")
+    .SetGroupName ("Ndn")
+    .SetParent<App> ()
+    .AddConstructor<ConsumerPopulation> ()
+
+    .AddAttribute ("Consumers", "Number of logical consumers",
+                   StringValue ("1"),
+                   MakeUintegerAccessor (&ConsumerPopulation::SetConsumerCount, &ConsumerPopulation::GetConsumerCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Prefix", "Name of the Interests, followed by the sequence number",
+                   StringValue ("/"),
+                   MakeStringAccessor (&ConsumerPopulation::m_prefix),
+                   MakeStringChecker ())
+    .AddAttribute ("Frequency", "Interests per second of each consumer",
+                   StringValue ("1.0"),
+                   MakeDoubleAccessor (&ConsumerPopulation::m_frequency),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("Randomize", "Randomization of the time between Interests: none, uniform or exponential",
+                   StringValue ("none"),
+                   MakeStringAccessor (&ConsumerPopulation::SetRandomize, &ConsumerPopulation::GetRandomize),
+                   MakeStringChecker ())
+    .AddAttribute ("MaxSeq", "Largest sequence number requested",
+                   UintegerValue (std::numeric_limits<uint32_t>::max ()),
+                   MakeUintegerAccessor (&ConsumerPopulation::m_maxSeq),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Repeat", "Start over from sequence number 0 after MaxSeq",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ConsumerPopulation::m_repeat),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LifeTime", "Interest lifetime",
+                   StringValue ("2s"),
+                   MakeTimeAccessor (&ConsumerPopulation::m_interestLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("ExclusionRate", "Probability that a good consumer excludes good content",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&ConsumerPopulation::m_exclusionRate),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("Popularity", "Names requested: sequential (Prefix/<seq> up to MaxSeq) or zipf (from a catalog)",
+                   StringValue ("sequential"),
+                   MakeStringAccessor (&ConsumerPopulation::SetPopularity, &ConsumerPopulation::GetPopularity),
+                   MakeStringChecker ())
+    .AddAttribute ("CatalogSize", "Number of names Prefix/0 .. Prefix/<CatalogSize - 1> of the zipf catalog",
+                   UintegerValue (10000),
+                   MakeUintegerAccessor (&ConsumerPopulation::m_catalogSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ZipfExponent", "Exponent of the zipf popularity law, P(rank) ~ 1 / (rank + 1)^ZipfExponent",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&ConsumerPopulation::m_zipfExponent),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("Scheduling", "Interest scheduling: events (one simulator event per Interest) or calendar (one per tick)",
+                   StringValue ("events"),
+                   MakeStringAccessor (&ConsumerPopulation::SetScheduling, &ConsumerPopulation::GetScheduling),
+                   MakeStringChecker ())
+    .AddAttribute ("CalendarTick", "Granularity of calendar scheduling, 0 for exact send times",
+                   StringValue ("1ms"),
+                   MakeTimeAccessor (&ConsumerPopulation::m_calendarTick),
+                   MakeTimeChecker ())
+    .AddAttribute ("DisableExclusion", "Never exclude received content",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&ConsumerPopulation::m_disableExclusion),
+                   MakeBooleanChecker ())
+
+    .AddTraceSource ("BadContentReceived", "Bad content received by any consumer",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_badContentReceived))
+    .AddTraceSource ("GoodContentReceived", "Good content received by any consumer",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_goodContentReceived))
+    .AddTraceSource ("StoppedOnGoodContent", "A consumer stopped on good content, and when",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_stoppedOnGoodContent))
+    .AddTraceSource ("ConsumerBadContentReceived", "Bad content received by a traced consumer",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_consumerBadContentReceived))
+    .AddTraceSource ("ConsumerGoodContentReceived", "Good content received by a traced consumer",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_consumerGoodContentReceived))
+    .AddTraceSource ("ConsumerStoppedOnGoodContent", "A traced consumer stopped on good content, and when",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_consumerStoppedOnGoodContent))
+    .AddTraceSource ("ConsumerReceivedContentObjects", "Content received by a traced consumer",
+                     MakeTraceSourceAccessor (&ConsumerPopulation::m_consumerReceivedContentObjects))
+    ;
+
+  return tid;
+}
+
+ConsumerPopulation::Consumer::Consumer ()
+  : malicious (false)
+  , stopOnGoodContent (false)
+  , traced (true)
+  , stopped (false)
+  , seq (0)
+{
+}
+
+ConsumerPopulation::ConsumerPopulation ()
+  : m_zipf (false)
+  , m_calendar (false)
+  , m_random (CreateObject<UniformRandomVariable> ())
+  , m_frequency (1.0)
+  , m_randomize ("none")
+{
+}
+
+ConsumerPopulation::~ConsumerPopulation ()
+{
+}
+
+void
+ConsumerPopulation::SetConsumerCount (uint32_t count)
+{
+  m_consumers.resize (count);
+}
+
+uint32_t
+ConsumerPopulation::GetConsumerCount () const
+{
+  return m_consumers.size ();
+}
+
+uint32_t
+ConsumerPopulation::GetN () const
+{
+  return m_consumers.size ();
+}
+
+void
+ConsumerPopulation::SetMalicious (uint32_t consumer, bool malicious)
+{
+  m_consumers.at (consumer).malicious = malicious;
+}
+
+bool
+ConsumerPopulation::IsMalicious (uint32_t consumer) const
+{
+  return m_consumers.at (consumer).malicious;
+}
+
+void
+ConsumerPopulation::SetStopOnGoodContent (uint32_t consumer, bool stop)
+{
+  m_consumers.at (consumer).stopOnGoodContent = stop;
+}
+
+void
+ConsumerPopulation::SetTraced (uint32_t consumer, bool traced)
+{
+  m_consumers.at (consumer).traced = traced;
+}
+
+int64_t
+ConsumerPopulation::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+void
+ConsumerPopulation::SetRandomize (const std::string &value)
+{
+  if (value != "none" && value != "uniform" && value != "exponential")
+    NS_FATAL_ERROR ("Unknown Randomize [" << value << "], expected none, uniform or exponential");
+
+  // As ConsumerCbr, draw from the seed and run current when the attribute is set
+  m_randomize = value;
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+std::string
+ConsumerPopulation::GetRandomize () const
+{
+  return m_randomize;
+}
+
+void
+ConsumerPopulation::SetPopularity (const std::string &value)
+{
+  if (value != "sequential" && value != "zipf")
+    NS_FATAL_ERROR ("Unknown Popularity [" << value << "], expected sequential or zipf");
+
+  m_zipf = value == "zipf";
+}
+
+std::string
+ConsumerPopulation::GetPopularity () const
+{
+  return m_zipf ? "zipf" : "sequential";
+}
+
+void
+ConsumerPopulation::SetScheduling (const std::string &value)
+{
+  if (value != "events" && value != "calendar")
+    NS_FATAL_ERROR ("Unknown Scheduling [" << value << "], expected events or calendar");
+
+  m_calendar = value == "calendar";
+}
+
+std::string
+ConsumerPopulation::GetScheduling () const
+{
+  return m_calendar ? "calendar" : "events";
+}
+
+Time
+ConsumerPopulation::GetSendInterval ()
+{
+  if (m_randomize == "uniform")
+    return Seconds (m_random->GetValue (0, 2.0 / m_frequency));
+  if (m_randomize == "exponential")
+    return Seconds (std::min (-std::log (1 - m_random->GetValue ()) / m_frequency, 50.0 / m_frequency));
+  return Seconds (1.0 / m_frequency);
+}
+
+void
+ConsumerPopulation::StartApplication ()
+{
+  App::StartApplication ();
+
+  // Built once per catalog, all populations of the simulation share it
+  m_catalog = 0;
+  if (m_zipf)
+    m_catalog = ZipfSampler::Get (m_catalogSize, m_zipfExponent);
+
+  m_pending.clear ();
+  m_deadlines.clear ();
+  for (uint32_t i = 0; i < m_consumers.size (); i++)
+    {
+      Consumer &consumer = m_consumers[i];
+      consumer.stopped = false;
+      consumer.seq = 0;
+      consumer.exclude = 0;
+      consumer.sendTime = Simulator::Now ();
+      ScheduleNextPacket (i, Seconds (0));
+    }
+}
+
+void
+ConsumerPopulation::StopApplication ()
+{
+  for (std::vector<Consumer>::iterator consumer = m_consumers.begin (); consumer != m_consumers.end (); consumer++)
+    Simulator::Cancel (consumer->sendEvent);
+  m_pending.clear ();
+  m_deadlines.clear ();
+
+  Simulator::Cancel (m_calendarEvent);
+  m_sends = std::priority_queue<Send, std::vector<Send>, std::greater<Send> > ();
+
+  App::StopApplication ();
+}
+
+void
+ConsumerPopulation::ScheduleNextPacket (uint32_t consumer, Time delay)
+{
+  if (!m_calendar)
+    {
+      m_consumers[consumer].sendEvent = Simulator::Schedule (delay, &ConsumerPopulation::SendPacket, this, consumer);
+      return;
+    }
+
+  Send send;
+  send.time = m_consumers[consumer].sendTime + delay;
+  send.consumer = consumer;
+  m_consumers[consumer].sendTime = send.time;
+  m_sends.push (send);
+  ScheduleCalendar (send.time);
+}
+
+void
+ConsumerPopulation::ScheduleCalendar (Time time)
+{
+  // End of the tick covering time
+  int64_t tick = m_calendarTick.GetTimeStep ();
+  if (tick > 0)
+    time = TimeStep ((time.GetTimeStep () + tick - 1) / tick * tick);
+  if (time < Simulator::Now ())
+    time = Simulator::Now ();
+
+  if (m_calendarEvent.IsRunning ())
+    {
+      if (m_calendarTime <= time)
+        return;
+      Simulator::Cancel (m_calendarEvent);
+    }
+
+  m_calendarTime = time;
+  m_calendarEvent = Simulator::Schedule (time - Simulator::Now (), &ConsumerPopulation::ProcessCalendar, this);
+}
+
+void
+ConsumerPopulation::ProcessCalendar ()
+{
+  // Interests sent here may already be due again (e.g., uniform intervals close to 0)
+  Time now = Simulator::Now ();
+  while (!m_sends.empty () && m_sends.top ().time <= now)
+    {
+      uint32_t consumer = m_sends.top ().consumer;
+      m_sends.pop ();
+      SendPacket (consumer);
+    }
+
+  if (!m_sends.empty ())
+    ScheduleCalendar (m_sends.top ().time);
+}
+
+void
+ConsumerPopulation::SendPacket (uint32_t index)
+{
+  Consumer &consumer = m_consumers[index];
+  if (!m_active || consumer.stopped)
+    return;
+
+  ExpirePending ();
+
+  uint32_t seq;
+  if (m_catalog)
+    seq = m_catalog->Sample (m_random->GetValue ());
+  else
+    {
+      if (consumer.seq > m_maxSeq)
+        {
+          if (!m_repeat)
+            return;
+          consumer.seq = 0;
+        }
+      seq = consumer.seq++;
+    }
+
+  Ptr<Name> name = Create<Name> (m_prefix);
+  (*name) (seq);
+
+  Ptr<Interest> interest = Create<Interest> ();
+  interest->SetNonce (m_random->GetInteger (0, std::numeric_limits<uint32_t>::max ()));
+  interest->SetName (name);
+  interest->SetInterestLifetime (m_interestLifetime);
+  if (consumer.exclude)
+    interest->SetExclude (consumer.exclude);
+
+  Pending pending;
+  pending.consumer = index;
+  pending.deadline = Simulator::Now () + m_interestLifetime;
+  m_pending[*name].push_back (pending);
+  m_deadlines.push_back (std::make_pair (pending.deadline, *name));
+
+  NS_LOG_INFO ("> Interest for " << *name << " from consumer " << index);
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (*interest);
+  m_protocolHandler (packet);
+  m_transmittedInterests (interest, this, m_face);
+
+  ScheduleNextPacket (index, GetSendInterval ());
+}
+
+void
+ConsumerPopulation::ExpirePending ()
+{
+  // All Interests have the same lifetime, so deadlines grow in send order, both here
+  // and in the queue of every name
+  Time now = Simulator::Now ();
+  while (!m_deadlines.empty () && m_deadlines.front ().first < now)
+    {
+      std::map<Name, std::deque<Pending> >::iterator pending = m_pending.find (m_deadlines.front ().second);
+      if (pending != m_pending.end ())
+        {
+          while (!pending->second.empty () && pending->second.front ().deadline < now)
+            pending->second.pop_front ();
+          if (pending->second.empty ())
+            m_pending.erase (pending);
+        }
+      m_deadlines.pop_front ();
+    }
+}
+
+void
+ConsumerPopulation::AddExclusion (uint32_t index, const name::Component &digest)
+{
+  // Interests already sent keep the filter they were sent with
+  Consumer &consumer = m_consumers[index];
+  Ptr<ndn::Exclude> exclude = consumer.exclude ? Create<ndn::Exclude> (*consumer.exclude) : Create<ndn::Exclude> ();
+  exclude->excludeOne (digest);
+  consumer.exclude = exclude;
+}
+
+void
+ConsumerPopulation::OnContentObject (const Ptr<const ContentObject> &contentObject, Ptr<Packet> payload)
+{
+  App::OnContentObject (contentObject, payload);
+  if (!m_active)
+    return;
+
+  std::map<Name, std::deque<Pending> >::iterator pending = m_pending.find (contentObject->GetName ());
+  if (pending == m_pending.end ())
+    return;
+
+  // The oldest live Interest that could have been answered with this version
+  name::Component digest = cs::RankingTable::GetDigestComponent (*contentObject, *payload);
+  Time now = Simulator::Now ();
+  int32_t index = -1;
+  for (std::deque<Pending>::iterator interest = pending->second.begin (); interest != pending->second.end (); )
+    {
+      if (interest->deadline < now)
+        {
+          interest = pending->second.erase (interest);
+          continue;
+        }
+
+      const Consumer &consumer = m_consumers[interest->consumer];
+      if (!consumer.exclude || !consumer.exclude->isExcluded (digest))
+        {
+          index = interest->consumer;
+          pending->second.erase (interest);
+          break;
+        }
+      interest++;
+    }
+  if (pending->second.empty ())
+    m_pending.erase (pending);
+  if (index < 0)
+    return;
+
+  Consumer &consumer = m_consumers[index];
+  if (consumer.traced)
+    m_consumerReceivedContentObjects (index, contentObject, payload);
+
+  if (contentObject->GetSignature () != 0)
+    {
+      m_badContentReceived (contentObject);
+      if (consumer.traced)
+        m_consumerBadContentReceived (index, contentObject);
+
+      if (!consumer.malicious && !m_disableExclusion)
+        AddExclusion (index, digest);
+      return;
+    }
+
+  m_goodContentReceived (contentObject);
+  if (consumer.traced)
+    m_consumerGoodContentReceived (index, contentObject);
+
+  if (!m_disableExclusion && (consumer.malicious || (m_exclusionRate > 0 && m_random->GetValue () < m_exclusionRate)))
+    {
+      AddExclusion (index, digest);
+      return;
+    }
+
+  consumer.exclude = 0;
+  if (consumer.stopOnGoodContent && !consumer.malicious)
+    {
+      consumer.stopped = true;
+      Simulator::Cancel (consumer.sendEvent);
+      m_stoppedOnGoodContent (contentObject, now);
+      if (consumer.traced)
+        m_consumerStoppedOnGoodContent (index, contentObject, now);
+    }
+}
+
+} // namespace ndn
+} // namespace ns3
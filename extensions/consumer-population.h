@@ -0,0 +1,260 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef NDN_CONSUMER_POPULATION_H
+#define NDN_CONSUMER_POPULATION_H
+
+#include "ns3/ndn-app.h"
+#include "ns3/ndn-name.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-content-object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+#include "zipf-sampler.h"
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Many logical ConsumerCbr consumers sharing one node, face and application
+ *
+ * Every logical consumer sends Interests for Prefix/<seq> at Frequency (randomized
+ * as ConsumerCbr's Randomize), and has its own role and state:
+ * - Malicious: excludes good content it receives, instead of bad content
+ * - StopOnGoodContent: stops sending once good content arrived
+ * - exclusion list: Exclude filter of its Interests, the digests
+ *   (cs::RankingTable::GetDigestComponent) of the content versions it rejected,
+ *   cleared when good content arrives
+ *
+ * Content is bad if its signature is not 0, as populated by cs::RankingTable.
+ *
+ * All consumers send through the application face, so the edge router sees one face
+ * instead of one per consumer.  Content arriving for a name goes to the consumer with
+ * the oldest pending Interest for it that does not exclude the content.  Interests of
+ * several consumers that the router aggregates in its PIT are therefore answered only
+ * once; with populated caches at edge routers every Interest is answered by the cache.
+ *
+ * With Popularity "zipf" every Interest is for Prefix/<rank> instead, the rank drawn
+ * from a catalog of CatalogSize names with Zipf popularity (ZipfExponent) by a
+ * ZipfSampler shared between all populations with the same catalog.
+ *
+ * With Scheduling "calendar" the send times of all consumers are kept in one calendar
+ * (a min-heap) instead of one simulator event per Interest.  A single event per
+ * CalendarTick sends every Interest due by then, so Interests are delayed by less than
+ * CalendarTick; the next send time of a consumer is drawn from its ideal, not its actual,
+ * send time, so intervals keep the Randomize distribution and do not drift.  With a
+ * CalendarTick of 0 send times are exact and consumers only share the event when
+ * their send times coincide.
+ *
+ * Besides the aggregated trace sources of ConsumerCbr (BadContentReceived,
+ * GoodContentReceived, StoppedOnGoodContent, ReceivedContentObjects), Consumer*
+ * trace sources fire with the index of the logical consumer, for traced consumers
+ * only (see SetTraced).
+ */
+class ConsumerPopulation : public App
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  ConsumerPopulation ();
+  virtual ~ConsumerPopulation ();
+
+  /**
+   * @brief Number of logical consumers (the Consumers attribute)
+   */
+  uint32_t
+  GetN () const;
+
+  void
+  SetMalicious (uint32_t consumer, bool malicious);
+
+  bool
+  IsMalicious (uint32_t consumer) const;
+
+  void
+  SetStopOnGoodContent (uint32_t consumer, bool stop);
+
+  /**
+   * @brief Whether Consumer* trace sources fire for consumer (default true)
+   */
+  void
+  SetTraced (uint32_t consumer, bool traced);
+
+  /**
+   * @brief Draw send intervals, nonces, ranks and exclusions from the given ns-3 RNG
+   * stream instead of an automatically assigned one
+   *
+   * Setting Randomize creates a new random variable, so call it afterwards.
+   * @returns number of streams used (1)
+   */
+  int64_t
+  AssignStreams (int64_t stream);
+
+  virtual void
+  OnContentObject (const Ptr<const ContentObject> &contentObject, Ptr<Packet> payload);
+
+protected:
+  virtual void
+  StartApplication ();
+
+  virtual void
+  StopApplication ();
+
+private:
+  /**
+   * @brief State of one logical consumer
+   */
+  struct Consumer
+  {
+    Consumer ();
+
+    bool malicious;
+    bool stopOnGoodContent;
+    bool traced;
+    bool stopped;
+    uint32_t seq;             ///< @brief sequence number of the next Interest
+    Time sendTime;            ///< @brief ideal time of the next Interest (calendar scheduling)
+    Ptr<Exclude> exclude;     ///< @brief 0 until the consumer rejects content
+    EventId sendEvent;
+  };
+
+  /**
+   * @brief Calendar entry, the next Interest of a consumer
+   */
+  struct Send
+  {
+    Time time;
+    uint32_t consumer;
+
+    bool
+    operator> (const Send &other) const
+    {
+      return time > other.time || (time == other.time && consumer > other.consumer);
+    }
+  };
+
+  /**
+   * @brief Interest of a consumer waiting for content
+   */
+  struct Pending
+  {
+    uint32_t consumer;
+    Time deadline;            ///< @brief end of the Interest lifetime
+  };
+
+  void
+  SetConsumerCount (uint32_t count);
+
+  uint32_t
+  GetConsumerCount () const;
+
+  void
+  SetRandomize (const std::string &value);
+
+  std::string
+  GetRandomize () const;
+
+  /**
+   * @brief Time until the next Interest of a consumer
+   */
+  Time
+  GetSendInterval ();
+
+  void
+  SetPopularity (const std::string &value);
+
+  std::string
+  GetPopularity () const;
+
+  void
+  SetScheduling (const std::string &value);
+
+  std::string
+  GetScheduling () const;
+
+  /**
+   * @brief Send the next Interest of consumer delay after its previous one
+   */
+  void
+  ScheduleNextPacket (uint32_t consumer, Time delay);
+
+  /**
+   * @brief Make sure the calendar event runs by the tick covering time
+   */
+  void
+  ScheduleCalendar (Time time);
+
+  /**
+   * @brief Send all Interests due, then schedule the next tick
+   */
+  void
+  ProcessCalendar ();
+
+  void
+  SendPacket (uint32_t consumer);
+
+  /**
+   * @brief Forget pending Interests whose lifetime ended, whether or not content for
+   * their name ever arrives
+   */
+  void
+  ExpirePending ();
+
+  /**
+   * @brief Add the content to the exclusion list of consumer
+   */
+  void
+  AddExclusion (uint32_t consumer, const name::Component &digest);
+
+private:
+  std::vector<Consumer> m_consumers;
+  std::map<Name, std::deque<Pending> > m_pending;
+  std::deque<std::pair<Time, Name> > m_deadlines; ///< @brief deadline and name of every Interest sent, in order
+
+  bool m_zipf;                  ///< @brief Popularity is "zipf"
+  Ptr<const ZipfSampler> m_catalog;
+
+  bool m_calendar;              ///< @brief Scheduling is "calendar"
+  std::priority_queue<Send, std::vector<Send>, std::greater<Send> > m_sends;
+  EventId m_calendarEvent;
+  Time m_calendarTime;          ///< @brief time of m_calendarEvent
+
+  Ptr<UniformRandomVariable> m_random;
+
+  // Attributes
+  std::string m_prefix;
+  double m_frequency;
+  std::string m_randomize;
+  uint32_t m_maxSeq;
+  bool m_repeat;
+  Time m_interestLifetime;
+  double m_exclusionRate;
+  bool m_disableExclusion;
+  uint32_t m_catalogSize;
+  double m_zipfExponent;
+  Time m_calendarTick;
+
+  TracedCallback<Ptr<const ContentObject> > m_badContentReceived;
+  TracedCallback<Ptr<const ContentObject> > m_goodContentReceived;
+  TracedCallback<Ptr<const ContentObject>, Time> m_stoppedOnGoodContent;
+
+  TracedCallback<uint32_t, Ptr<const ContentObject> > m_consumerBadContentReceived;
+  TracedCallback<uint32_t, Ptr<const ContentObject> > m_consumerGoodContentReceived;
+  TracedCallback<uint32_t, Ptr<const ContentObject>, Time> m_consumerStoppedOnGoodContent;
+  TracedCallback<uint32_t, Ptr<const ContentObject>, Ptr<const Packet> > m_consumerReceivedContentObjects;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CONSUMER_POPULATION_H
@@ -0,0 +1,121 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "consumer-trace-helper.h"
+
+NS_LOG_COMPONENT_DEFINE ("ConsumerTraceHelper");
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * @brief Forwards trace source arguments to a sink, prepending the node id
+ *
+ * Kept alive by the reference held by the trace source's callback
+ */
+class ContentSink : public SimpleRefCount<ContentSink>
+{
+public:
+  ContentSink (uint32_t nodeId, ConsumerTraceHelper::ContentCallback sink)
+    : m_nodeId (nodeId)
+    , m_sink (sink)
+  {
+  }
+
+  void
+  Invoke (Ptr<const ndn::ContentObject> content)
+  {
+    m_sink (m_nodeId, content);
+  }
+
+private:
+  uint32_t m_nodeId;
+  ConsumerTraceHelper::ContentCallback m_sink;
+};
+
+class ReceivedContentSink : public SimpleRefCount<ReceivedContentSink>
+{
+public:
+  ReceivedContentSink (uint32_t nodeId, ConsumerTraceHelper::ReceivedContentCallback sink)
+    : m_nodeId (nodeId)
+    , m_sink (sink)
+  {
+  }
+
+  void
+  Invoke (Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet, Ptr<ndn::App> app, Ptr<ndn::Face> face)
+  {
+    m_sink (m_nodeId, content, packet, app, face);
+  }
+
+private:
+  uint32_t m_nodeId;
+  ConsumerTraceHelper::ReceivedContentCallback m_sink;
+};
+
+class StoppedSink : public SimpleRefCount<StoppedSink>
+{
+public:
+  StoppedSink (uint32_t nodeId, ConsumerTraceHelper::StoppedCallback sink)
+    : m_nodeId (nodeId)
+    , m_sink (sink)
+  {
+  }
+
+  void
+  Invoke (Ptr<const ndn::ContentObject> content, Time stoppingTime)
+  {
+    m_sink (m_nodeId, content, stoppingTime);
+  }
+
+private:
+  uint32_t m_nodeId;
+  ConsumerTraceHelper::StoppedCallback m_sink;
+};
+
+void
+Connect (Ptr<Application> app, const std::string &traceSource, const CallbackBase &callback)
+{
+  if (!app->TraceConnectWithoutContext (traceSource, callback))
+    NS_FATAL_ERROR ("Application on node " << app->GetNode ()->GetId ()
+                    << " does not provide trace source [" << traceSource << "]");
+}
+
+} // namespace
+
+void
+ConsumerTraceHelper::ConnectBadContentReceived (Ptr<Application> app, ContentCallback sink)
+{
+  Ptr<ContentSink> adapter = Create<ContentSink> (app->GetNode ()->GetId (), sink);
+  Connect (app, "BadContentReceived", MakeCallback (&ContentSink::Invoke, adapter));
+}
+
+void
+ConsumerTraceHelper::ConnectGoodContentReceived (Ptr<Application> app, ContentCallback sink)
+{
+  Ptr<ContentSink> adapter = Create<ContentSink> (app->GetNode ()->GetId (), sink);
+  Connect (app, "GoodContentReceived", MakeCallback (&ContentSink::Invoke, adapter));
+}
+
+void
+ConsumerTraceHelper::ConnectReceivedContentObjects (Ptr<Application> app, ReceivedContentCallback sink)
+{
+  Ptr<ReceivedContentSink> adapter = Create<ReceivedContentSink> (app->GetNode ()->GetId (), sink);
+  Connect (app, "ReceivedContentObjects", MakeCallback (&ReceivedContentSink::Invoke, adapter));
+}
+
+void
+ConsumerTraceHelper::ConnectStoppedOnGoodContent (Ptr<Application> app, StoppedCallback sink)
+{
+  Ptr<StoppedSink> adapter = Create<StoppedSink> (app->GetNode ()->GetId (), sink);
+  Connect (app, "StoppedOnGoodContent", MakeCallback (&StoppedSink::Invoke, adapter));
+}
+
+void
+ConsumerTraceHelper::ConnectConsumerStoppedOnGoodContent (Ptr<Application> population, StoppedCallback sink)
+{
+  // The trace source already has the consumer index in place of the node id
+  Connect (population, "ConsumerStoppedOnGoodContent", sink);
+}
+
+} // namespace ns3
@@ -0,0 +1,63 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef CONSUMER_TRACE_HELPER_H
+#define CONSUMER_TRACE_HELPER_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+
+namespace ns3 {
+
+/**
+ * @brief Connects trace sinks directly to the consumer applications returned by AppHelper::Install
+ *
+ * Replacement for
+ * Config::Connect ("/NodeList/<id>/ApplicationList/0/BadContentReceived", ...):
+ * no path string is built or resolved when connecting, and instead of a context
+ * string the sinks get the id of the node the application is installed on.
+ */
+class ConsumerTraceHelper
+{
+public:
+  typedef Callback<void, uint32_t, Ptr<const ndn::ContentObject> > ContentCallback;
+  typedef Callback<void, uint32_t, Ptr<const ndn::ContentObject>, Ptr<const Packet>,
+                   Ptr<ndn::App>, Ptr<ndn::Face> > ReceivedContentCallback;
+  typedef Callback<void, uint32_t, Ptr<const ndn::ContentObject>, Time> StoppedCallback;
+
+  /**
+   * @brief Connect sink to the BadContentReceived trace source of app
+   */
+  static void
+  ConnectBadContentReceived (Ptr<Application> app, ContentCallback sink);
+
+  /**
+   * @brief Connect sink to the GoodContentReceived trace source of app
+   */
+  static void
+  ConnectGoodContentReceived (Ptr<Application> app, ContentCallback sink);
+
+  /**
+   * @brief Connect sink to the ReceivedContentObjects trace source of app
+   */
+  static void
+  ConnectReceivedContentObjects (Ptr<Application> app, ReceivedContentCallback sink);
+
+  /**
+   * @brief Connect sink to the StoppedOnGoodContent trace source of app
+   */
+  static void
+  ConnectStoppedOnGoodContent (Ptr<Application> app, StoppedCallback sink);
+
+  /**
+   * @brief Connect sink to the ConsumerStoppedOnGoodContent trace source of a ConsumerPopulation
+   *
+   * Instead of the node id, the sink gets the index of the logical consumer.
+   */
+  static void
+  ConnectConsumerStoppedOnGoodContent (Ptr<Application> population, StoppedCallback sink);
+};
+
+} // namespace ns3
+
+#endif // CONSUMER_TRACE_HELPER_H
@@ -0,0 +1,122 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "exclude-matcher.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace ns3 {
+namespace ndn {
+
+ExcludeMatcher::ExcludeMatcher ()
+  : m_ranges (false)
+{
+}
+
+void
+ExcludeMatcher::Compile (const Exclude &exclude)
+{
+  m_digests.clear ();
+  m_ranges = false;
+
+  for (Exclude::const_iterator component = exclude.begin (); component != exclude.end (); component++)
+    {
+      if (component->second)
+        m_ranges = true;
+
+      uint64_t digest;
+      if (ParseDigest (component->first, digest))
+        m_digests.push_back (digest);
+    }
+
+  // Exclude filters keep their components ordered, and fixed-width hex digits
+  // order like the digests they encode, so sorting is usually a no-op or a reversal
+  bool ascending = true;
+  bool descending = true;
+  for (uint32_t i = 1; i < m_digests.size () && (ascending || descending); i++)
+    {
+      ascending = ascending && m_digests[i - 1] <= m_digests[i];
+      descending = descending && m_digests[i - 1] >= m_digests[i];
+    }
+  if (descending && !ascending)
+    std::reverse (m_digests.begin (), m_digests.end ());
+  else if (!ascending)
+    std::sort (m_digests.begin (), m_digests.end ());
+
+  m_digests.erase (std::unique (m_digests.begin (), m_digests.end ()), m_digests.end ());
+}
+
+void
+ExcludeMatcher::Clear ()
+{
+  m_digests.clear ();
+  m_ranges = false;
+}
+
+bool
+ExcludeMatcher::HasRanges () const
+{
+  return m_ranges;
+}
+
+const std::vector<uint64_t> &
+ExcludeMatcher::GetDigests () const
+{
+  return m_digests;
+}
+
+namespace {
+
+/**
+ * @brief Value of every hex digit character, 0xff for other characters
+ */
+struct HexDigits
+{
+  HexDigits ()
+  {
+    for (int c = 0; c < 256; c++)
+      values[c] = 0xff;
+    for (int c = '0'; c <= '9'; c++)
+      values[c] = c - '0';
+    for (int c = 'a'; c <= 'f'; c++)
+      values[c] = c - 'a' + 10;
+    for (int c = 'A'; c <= 'F'; c++)
+      values[c] = c - 'A' + 10;
+  }
+
+  uint8_t values[256];
+};
+
+const HexDigits g_hexDigits;
+
+} // namespace
+
+bool
+ExcludeMatcher::ParseDigest (const name::Component &component, uint64_t &digest)
+{
+  if (component.size () != 16)
+    return false;
+
+  digest = 0;
+  uint8_t invalid = 0;
+  for (name::Component::const_iterator c = component.begin (); c != component.end (); c++)
+    {
+      uint8_t value = g_hexDigits.values[static_cast<uint8_t> (*c)];
+      invalid |= value;
+      digest = (digest << 4) | (value & 0x0f);
+    }
+  // Only non-digit characters have the high bits set
+  return (invalid & 0xf0) == 0;
+}
+
+name::Component
+ExcludeMatcher::MakeComponent (uint64_t digest)
+{
+  std::ostringstream component;
+  component << std::hex << std::setfill ('0') << std::setw (16) << digest;
+  return name::Component (component.str ());
+}
+
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef NDN_EXCLUDE_MATCHER_H
+#define NDN_EXCLUDE_MATCHER_H
+
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-name.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Exclude filter compiled into a sorted array of 64-bit digests
+ *
+ * Content versions are excluded by their implicit digest, a name component of 16 hex
+ * digits (see MakeComponent).  Compile parses every such component of an Exclude
+ * filter once, so that matching a version is a binary search over packed integers
+ * instead of component comparisons.  Components that are not digests cannot match a
+ * version and are dropped.  Ranges (excludeAfter/excludeBefore) are not compiled:
+ * when HasRanges () is true, Exclude::isExcluded has to be used instead.
+ */
+class ExcludeMatcher
+{
+public:
+  ExcludeMatcher ();
+
+  /**
+   * @brief Replace the compiled filter, reusing the storage of the previous one
+   */
+  void
+  Compile (const Exclude &exclude);
+
+  /**
+   * @brief Drop the compiled filter (nothing is excluded)
+   */
+  void
+  Clear ();
+
+  bool
+  HasRanges () const;
+
+  /**
+   * @brief True if one of the excluded components is the given digest
+   */
+  inline bool
+  IsExcluded (uint64_t digest) const
+  {
+    if (m_digests.empty ())
+      return false;
+
+    // Branch-free lower bound: the loop runs log2 (size) times whatever the digest,
+    // and the comparison compiles to a conditional move
+    const uint64_t *base = &m_digests[0];
+    uint32_t count = m_digests.size ();
+    while (count > 1)
+      {
+        uint32_t half = count / 2;
+        base = base[half] <= digest ? base + half : base;
+        count -= half;
+      }
+    return *base == digest;
+  }
+
+  /**
+   * @brief Excluded digests, sorted and without duplicates
+   */
+  const std::vector<uint64_t> &
+  GetDigests () const;
+
+  /**
+   * @brief Parse a digest component, false if component is not one
+   */
+  static bool
+  ParseDigest (const name::Component &component, uint64_t &digest);
+
+  /**
+   * @brief Digest component of a 64-bit digest, 16 lowercase hex digits
+   */
+  static name::Component
+  MakeComponent (uint64_t digest);
+
+private:
+  std::vector<uint64_t> m_digests;
+  bool m_ranges;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_EXCLUDE_MATCHER_H
@@ -0,0 +1,113 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "face-sketch.h"
+
+#include "ns3/fatal-error.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+FaceSketch::FaceSketch (uint32_t registers, uint32_t width)
+  : m_registers (registers)
+  , m_registerBits (0)
+  , m_width (width)
+{
+  if (registers < 16 || registers > 65536 || (registers & (registers - 1)) != 0)
+    NS_FATAL_ERROR ("Number of sketch registers must be a power of two from 16 to 65536, not " << registers);
+  if (width == 0)
+    NS_FATAL_ERROR ("Width of the sketch counters must be positive");
+
+  while ((1u << m_registerBits) < registers)
+    m_registerBits++;
+
+  // Bias correction of the raw HyperLogLog estimate
+  if (registers == 16)
+    m_alpha = 0.673;
+  else if (registers == 32)
+    m_alpha = 0.697;
+  else if (registers == 64)
+    m_alpha = 0.709;
+  else
+    m_alpha = 0.7213 / (1 + 1.079 / registers);
+}
+
+uint32_t
+FaceSketch::GetRegisterCount () const
+{
+  return m_registers;
+}
+
+uint32_t
+FaceSketch::GetWidth () const
+{
+  return m_width;
+}
+
+uint32_t
+FaceSketch::GetCounterCount () const
+{
+  return DEPTH * m_width;
+}
+
+uint32_t
+FaceSketch::GetBytes () const
+{
+  return m_registers * sizeof (uint8_t) + GetCounterCount () * sizeof (uint32_t);
+}
+
+uint64_t
+FaceSketch::Hash (uint64_t value)
+{
+  // splitmix64 finalizer: face ids are small consecutive integers
+  value += 0x9E3779B97F4A7C15ULL;
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+void
+FaceSketch::Add (uint8_t *registers, uint32_t *counters, uint32_t faceId) const
+{
+  uint64_t hash = Hash (faceId);
+
+  // Register picked by the top bits, rank of the first set bit among the others
+  uint32_t registerIndex = static_cast<uint32_t> (hash >> (64 - m_registerBits));
+  uint64_t rest = hash << m_registerBits;
+  uint8_t rank = rest == 0 ? 64 - m_registerBits + 1 : __builtin_clzll (rest) + 1;
+  if (registers[registerIndex] < rank)
+    registers[registerIndex] = rank;
+
+  uint64_t columns = Hash (hash);
+  counters[static_cast<uint32_t> (columns) % m_width]++;
+  counters[m_width + static_cast<uint32_t> (columns >> 32) % m_width]++;
+}
+
+double
+FaceSketch::EstimateFaces (const uint8_t *registers) const
+{
+  double sum = 0;
+  uint32_t zeros = 0;
+  for (uint32_t i = 0; i < m_registers; i++)
+    {
+      sum += std::ldexp (1.0, -registers[i]);
+      zeros += registers[i] == 0;
+    }
+
+  double estimate = m_alpha * m_registers * m_registers / sum;
+  // Linear counting is more accurate for the few faces of most versions
+  if (estimate <= 2.5 * m_registers && zeros != 0)
+    estimate = m_registers * std::log (static_cast<double> (m_registers) / zeros);
+  return estimate;
+}
+
+uint32_t
+FaceSketch::EstimateExclusions (const uint32_t *counters, uint32_t faceId) const
+{
+  uint64_t columns = Hash (Hash (faceId));
+  uint32_t first = counters[static_cast<uint32_t> (columns) % m_width];
+  uint32_t second = counters[m_width + static_cast<uint32_t> (columns >> 32) % m_width];
+  return first < second ? first : second;
+}
+
+} // namespace ns3
@@ -0,0 +1,81 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef FACE_SKETCH_H
+#define FACE_SKETCH_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * @brief Fixed-size summary of the faces that excluded one content version
+ *
+ * A sketch is a HyperLogLog register array estimating the number of distinct excluding
+ * faces, and a count-min sketch of DEPTH rows of GetWidth () counters estimating how
+ * many exclusions came from a given face (never underestimated).  The sketch itself
+ * is stored by the caller, e.g., one slice per version of flat register and counter
+ * arrays; this class only holds the geometry and the update and estimate functions.
+ */
+class FaceSketch
+{
+public:
+  static const uint32_t DEPTH = 2;
+
+  /**
+   * @param registers number of HyperLogLog registers, a power of two from 16 to 65536
+   * @param width number of counters per count-min row
+   *
+   * Aborts the program if the geometry is invalid
+   */
+  FaceSketch (uint32_t registers = 16, uint32_t width = 8);
+
+  uint32_t
+  GetRegisterCount () const;
+
+  uint32_t
+  GetWidth () const;
+
+  /**
+   * @brief Number of count-min counters of one sketch, DEPTH * GetWidth ()
+   */
+  uint32_t
+  GetCounterCount () const;
+
+  /**
+   * @brief Memory of one sketch, in bytes
+   */
+  uint32_t
+  GetBytes () const;
+
+  /**
+   * @brief Record one exclusion by faceId in the sketch made of registers and counters
+   */
+  void
+  Add (uint8_t *registers, uint32_t *counters, uint32_t faceId) const;
+
+  /**
+   * @brief Estimated number of distinct faces recorded in registers
+   */
+  double
+  EstimateFaces (const uint8_t *registers) const;
+
+  /**
+   * @brief Estimated (upper bound of the) number of exclusions recorded for faceId
+   */
+  uint32_t
+  EstimateExclusions (const uint32_t *counters, uint32_t faceId) const;
+
+private:
+  static uint64_t
+  Hash (uint64_t value);
+
+private:
+  uint32_t m_registers;
+  uint32_t m_registerBits;
+  uint32_t m_width;
+  double m_alpha;
+};
+
+} // namespace ns3
+
+#endif // FACE_SKETCH_H
@@ -0,0 +1,249 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "metrics-registry.h"
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/ndnSIM-module.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+NS_LOG_COMPONENT_DEFINE ("MetricsRegistry");
+
+namespace ns3 {
+
+static const uint32_t CACHE_LINE = 64;
+static const uint32_t VALUES_PER_LINE = CACHE_LINE / sizeof (int64_t);
+
+static int64_t *
+AllocateValues (uint32_t capacity)
+{
+  void *values = 0;
+  if (posix_memalign (&values, CACHE_LINE, std::max<uint32_t> (capacity, 1) * sizeof (int64_t)) != 0)
+    NS_FATAL_ERROR ("Cannot allocate " << capacity << " metric values");
+
+  memset (values, 0, capacity * sizeof (int64_t));
+  return static_cast<int64_t *> (values);
+}
+
+MetricsRegistry::MetricsRegistry ()
+  : m_values (AllocateValues (0))
+  , m_size (0)
+  , m_capacity (0)
+{
+}
+
+MetricsRegistry::MetricsRegistry (const MetricsRegistry &other)
+  : m_metrics (other.m_metrics)
+  , m_values (AllocateValues (other.m_size))
+  , m_size (other.m_size)
+  , m_capacity (other.m_size)
+{
+  std::copy (other.m_values, other.m_values + other.m_size, m_values);
+}
+
+MetricsRegistry &
+MetricsRegistry::operator= (const MetricsRegistry &other)
+{
+  if (this == &other)
+    return *this;
+
+  int64_t *values = AllocateValues (other.m_size);
+  std::copy (other.m_values, other.m_values + other.m_size, values);
+  free (m_values);
+
+  m_metrics = other.m_metrics;
+  m_values = values;
+  m_size = other.m_size;
+  m_capacity = other.m_size;
+  return *this;
+}
+
+MetricsRegistry::~MetricsRegistry ()
+{
+  free (m_values);
+}
+
+const MetricsRegistry::Metric *
+MetricsRegistry::Find (const std::string &name) const
+{
+  for (std::vector<Metric>::const_iterator metric = m_metrics.begin (); metric != m_metrics.end (); metric++)
+    {
+      if (metric->name == name)
+        return &(*metric);
+    }
+  return 0;
+}
+
+uint32_t
+MetricsRegistry::Allocate (const std::string &name, Type type, uint32_t size)
+{
+  const Metric *existing = Find (name);
+  if (existing != 0)
+    {
+      if (existing->type != type || existing->size != size)
+        NS_FATAL_ERROR ("Metric [" << name << "] is already registered with a different type or size");
+      return existing->offset;
+    }
+
+  // Round up to whole cache lines, so that metrics never share a line
+  uint32_t lines = (std::max<uint32_t> (size, 1) + VALUES_PER_LINE - 1) / VALUES_PER_LINE;
+  uint32_t offset = m_size;
+  if (m_size + lines * VALUES_PER_LINE > m_capacity)
+    {
+      uint32_t capacity = std::max (m_size + lines * VALUES_PER_LINE, 2 * m_capacity);
+      int64_t *values = AllocateValues (capacity);
+      std::copy (m_values, m_values + m_size, values);
+      free (m_values);
+      m_values = values;
+      m_capacity = capacity;
+    }
+  m_size += lines * VALUES_PER_LINE;
+
+  Metric metric;
+  metric.name = name;
+  metric.type = type;
+  metric.offset = offset;
+  metric.size = size;
+  m_metrics.push_back (metric);
+
+  NS_LOG_DEBUG (name << ": offset " << offset << ", size " << size);
+  return offset;
+}
+
+MetricsRegistry::CounterId
+MetricsRegistry::AddCounter (const std::string &name)
+{
+  return Allocate (name, COUNTER, 1);
+}
+
+MetricsRegistry::HistogramId
+MetricsRegistry::AddHistogram (const std::string &name, uint32_t bins)
+{
+  return Allocate (name, HISTOGRAM, bins);
+}
+
+uint32_t
+MetricsRegistry::GetBinCount (HistogramId id) const
+{
+  for (std::vector<Metric>::const_iterator metric = m_metrics.begin (); metric != m_metrics.end (); metric++)
+    {
+      if (metric->offset == id)
+        return metric->size;
+    }
+  NS_FATAL_ERROR ("Unknown histogram id " << id);
+  return 0;
+}
+
+void
+MetricsRegistry::Reset ()
+{
+  std::fill (m_values, m_values + m_size, 0);
+}
+
+void
+MetricsRegistry::Merge (const MetricsRegistry &other)
+{
+  for (std::vector<Metric>::const_iterator metric = other.m_metrics.begin (); metric != other.m_metrics.end (); metric++)
+    {
+      uint32_t offset = Allocate (metric->name, metric->type, metric->size);
+      for (uint32_t i = 0; i < metric->size; i++)
+        m_values[offset + i] += other.m_values[metric->offset + i];
+    }
+}
+
+void
+MetricsRegistry::Serialize (std::ostream &os) const
+{
+  os << m_metrics.size () << "\n";
+  for (std::vector<Metric>::const_iterator metric = m_metrics.begin (); metric != m_metrics.end (); metric++)
+    {
+      os << metric->name << " " << metric->type << " " << metric->size;
+      for (uint32_t i = 0; i < metric->size; i++)
+        os << " " << m_values[metric->offset + i];
+      os << "\n";
+    }
+}
+
+bool
+MetricsRegistry::Deserialize (std::istream &is)
+{
+  *this = MetricsRegistry ();
+
+  size_t count = 0;
+  if (!(is >> count))
+    return false;
+
+  for (size_t i = 0; i < count; i++)
+    {
+      std::string name;
+      int type;
+      uint32_t size;
+      if (!(is >> name >> type >> size) || (type != COUNTER && type != HISTOGRAM))
+        return false;
+
+      uint32_t offset = Allocate (name, static_cast<Type> (type), size);
+      for (uint32_t j = 0; j < size; j++)
+        {
+          if (!(is >> m_values[offset + j]))
+            return false;
+        }
+    }
+  return true;
+}
+
+namespace {
+
+/**
+ * @brief Trace sinks incrementing a registry counter
+ */
+class CountingSink : public SimpleRefCount<CountingSink>
+{
+public:
+  CountingSink (MetricsRegistry *registry, MetricsRegistry::CounterId id)
+    : m_registry (registry)
+    , m_id (id)
+  {
+  }
+
+  void
+  ContentReceived (Ptr<const ndn::ContentObject> content)
+  {
+    m_registry->Increment (m_id);
+  }
+
+  void
+  ContentObjectsReceived (Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet,
+                          Ptr<ndn::App> app, Ptr<ndn::Face> face)
+  {
+    m_registry->Increment (m_id);
+  }
+
+private:
+  MetricsRegistry *m_registry;
+  MetricsRegistry::CounterId m_id;
+};
+
+} // namespace
+
+void
+MetricsRegistry::CountTrace (Ptr<Application> app, const std::string &traceSource, CounterId id)
+{
+  Ptr<CountingSink> sink = Create<CountingSink> (this, id);
+
+  bool connected = false;
+  if (traceSource == "BadContentReceived" || traceSource == "GoodContentReceived")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&CountingSink::ContentReceived, sink));
+  else if (traceSource == "ReceivedContentObjects")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&CountingSink::ContentObjectsReceived, sink));
+  else
+    NS_FATAL_ERROR ("Counting trace source [" << traceSource << "] is not supported");
+
+  if (!connected)
+    NS_FATAL_ERROR ("Application on node " << app->GetNode ()->GetId ()
+                    << " does not provide trace source [" << traceSource << "]");
+}
+
+} // namespace ns3
@@ -0,0 +1,155 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef METRICS_REGISTRY_H
+#define METRICS_REGISTRY_H
+
+#include "ns3/ptr.h"
+#include "ns3/application.h"
+
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Named counters and histograms with a non-atomic, cache-line-aligned hot path
+ *
+ * Every counter occupies its own 64-byte cache line, every histogram starts on a
+ * cache line boundary.  Ids returned by AddCounter/AddHistogram are offsets into the
+ * value array, so Increment is a single indexed add.
+ *
+ * A registry is not thread safe.  Concurrent iterations (e.g., worker processes) use
+ * their own shard, a copy of the registry with Reset () values, which is merged back
+ * by name with Merge.
+ */
+class MetricsRegistry
+{
+public:
+  typedef uint32_t CounterId;
+  typedef uint32_t HistogramId;
+
+  MetricsRegistry ();
+
+  MetricsRegistry (const MetricsRegistry &other);
+
+  MetricsRegistry &
+  operator= (const MetricsRegistry &other);
+
+  ~MetricsRegistry ();
+
+  /**
+   * @brief Register a counter, or get id of an existing counter with the same name
+   */
+  CounterId
+  AddCounter (const std::string &name);
+
+  /**
+   * @brief Register a histogram, or get id of an existing histogram with the same name
+   */
+  HistogramId
+  AddHistogram (const std::string &name, uint32_t bins);
+
+  inline void
+  Increment (CounterId id)
+  {
+    m_values[id]++;
+  }
+
+  inline void
+  Add (CounterId id, int64_t value)
+  {
+    m_values[id] += value;
+  }
+
+  inline void
+  Set (CounterId id, int64_t value)
+  {
+    m_values[id] = value;
+  }
+
+  inline int64_t
+  Get (CounterId id) const
+  {
+    return m_values[id];
+  }
+
+  inline void
+  AddToBin (HistogramId id, uint32_t bin, int64_t value)
+  {
+    m_values[id + bin] += value;
+  }
+
+  inline int64_t
+  GetBin (HistogramId id, uint32_t bin) const
+  {
+    return m_values[id + bin];
+  }
+
+  uint32_t
+  GetBinCount (HistogramId id) const;
+
+  /**
+   * @brief Set all values to zero, keeping registered metrics
+   */
+  void
+  Reset ();
+
+  /**
+   * @brief Add values of another registry (shard), matching metrics by name
+   *
+   * Metrics missing in this registry are added
+   */
+  void
+  Merge (const MetricsRegistry &other);
+
+  void
+  Serialize (std::ostream &os) const;
+
+  /**
+   * @brief Replace contents with metrics written by Serialize
+   */
+  bool
+  Deserialize (std::istream &is);
+
+  /**
+   * @brief Increment counter id on every invocation of a consumer trace source
+   * @param traceSource BadContentReceived, GoodContentReceived or ReceivedContentObjects
+   *
+   * The registry must outlive the simulation app is part of
+   */
+  void
+  CountTrace (Ptr<Application> app, const std::string &traceSource, CounterId id);
+
+private:
+  enum Type
+    {
+      COUNTER,
+      HISTOGRAM
+    };
+
+  struct Metric
+  {
+    std::string name;
+    Type type;
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  const Metric *
+  Find (const std::string &name) const;
+
+  uint32_t
+  Allocate (const std::string &name, Type type, uint32_t size);
+
+private:
+  std::vector<Metric> m_metrics;
+  int64_t *m_values;   ///< @brief cache-line-aligned
+  uint32_t m_size;     ///< @brief number of used values (multiple of a cache line)
+  uint32_t m_capacity;
+};
+
+} // namespace ns3
+
+#endif // METRICS_REGISTRY_H
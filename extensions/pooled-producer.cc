@@ -0,0 +1,165 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "pooled-producer.h"
+#include "ranking-table.h"
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/ndn-fib.h"
+
+NS_LOG_COMPONENT_DEFINE ("ndn.PooledProducer");
+
+namespace ns3 {
+namespace ndn {
+
+NS_OBJECT_ENSURE_REGISTERED (PooledProducer);
+
+TypeId
+PooledProducer::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::PooledProducer")
+    .SetGroupName ("Ndn")
+    .SetParent<App> ()
+    .AddConstructor<PooledProducer> ()
+
+    .AddAttribute ("Prefix", "Prefix for which the producer has data",
+                   StringValue ("/"),
+                   MakeStringAccessor (&PooledProducer::m_prefix),
+                   MakeStringChecker ())
+    .AddAttribute ("PayloadSize", "Virtual payload size of content objects",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&PooledProducer::m_payloadSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Freshness", "Freshness of content objects, 0 for unlimited",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&PooledProducer::m_freshness),
+                   MakeTimeChecker ())
+    .AddAttribute ("BadContentRate", "Probability that an Interest is answered with bad content",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&PooledProducer::m_badContentRate),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("PoolSize", "Number of pre-built content objects of each kind, good and bad",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&PooledProducer::m_poolSize),
+                   MakeUintegerChecker<uint32_t> (1))
+
+    .AddTraceSource ("BadContentTransmitted", "Bad content sent in answer to an Interest",
+                     MakeTraceSourceAccessor (&PooledProducer::m_badContentTransmitted))
+    ;
+
+  return tid;
+}
+
+PooledProducer::PooledProducer ()
+  : m_nextGood (0)
+  , m_nextBad (0)
+  , m_random (CreateObject<UniformRandomVariable> ())
+  , m_payloadSize (1024)
+  , m_badContentRate (0.0)
+  , m_poolSize (64)
+{
+}
+
+int64_t
+PooledProducer::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+void
+PooledProducer::StartApplication ()
+{
+  App::StartApplication ();
+
+  Ptr<Name> prefix = Create<Name> (m_prefix);
+  Ptr<Fib> fib = GetNode ()->GetObject<Fib> ();
+  Ptr<fib::Entry> fibEntry = fib->Add (*prefix, m_face, 0);
+  fibEntry->UpdateStatus (m_face, fib::FaceMetric::NDN_FIB_GREEN);
+
+  // The same buffer as populated content of this size
+  m_payload = cs::RankingTable::GetSharedPayload (m_payloadSize);
+  BuildPool (m_good, 0, prefix);
+  BuildPool (m_bad, 1, prefix);
+  m_nextGood = 0;
+  m_nextBad = 0;
+}
+
+void
+PooledProducer::StopApplication ()
+{
+  m_good.clear ();
+  m_bad.clear ();
+
+  App::StopApplication ();
+}
+
+void
+PooledProducer::BuildPool (std::vector<Entry> &pool, uint32_t signature, Ptr<const Name> name)
+{
+  // Bad objects after the good ones, so that every object has its own timestamp
+  Time first = Simulator::Now () + NanoSeconds (signature * m_poolSize);
+
+  pool.resize (m_poolSize);
+  for (uint32_t i = 0; i < m_poolSize; i++)
+    {
+      Ptr<ContentObject> header = Create<ContentObject> ();
+      header->SetName (Create<Name> (*name));
+      header->SetFreshness (m_freshness);
+      header->SetTimestamp (first + NanoSeconds (i));
+      header->SetSignature (signature);
+
+      pool[i].header = header;
+      Encode (pool[i]);
+    }
+}
+
+void
+PooledProducer::Encode (Entry &entry)
+{
+  static ContentObjectTail tail;
+  entry.packet = m_payload->Copy ();
+  entry.packet->AddHeader (*entry.header);
+  entry.packet->AddTrailer (tail);
+}
+
+void
+PooledProducer::OnInterest (Ptr<const Interest> interest, Ptr<Packet> origPacket)
+{
+  App::OnInterest (interest, origPacket);
+  if (!m_active)
+    return;
+
+  bool bad = m_badContentRate > 0 && m_random->GetValue () < m_badContentRate;
+  Entry &entry = bad ? m_bad[m_nextBad] : m_good[m_nextGood];
+  if (bad)
+    m_nextBad = (m_nextBad + 1) % m_bad.size ();
+  else
+    m_nextGood = (m_nextGood + 1) % m_good.size ();
+
+  if (!(entry.header->GetName () == interest->GetName ()))
+    {
+      // A new header: the previous one may still be held by trace sinks
+      Ptr<ContentObject> header = Create<ContentObject> (*entry.header);
+      header->SetName (Create<Name> (interest->GetName ()));
+      entry.header = header;
+      Encode (entry);
+    }
+
+  NS_LOG_INFO ("node(" << GetNode ()->GetId () << ") responding with " << (bad ? "bad" : "good")
+               << " ContentObject for " << entry.header->GetName ());
+
+  // Copy-on-write: only the packet object is new, header and payload buffers are shared
+  Ptr<Packet> packet = entry.packet->Copy ();
+  m_protocolHandler (packet);
+  m_transmittedContentObjects (entry.header, packet, this, m_face);
+  if (bad)
+    m_badContentTransmitted (entry.header);
+}
+
+} // namespace ndn
+} // namespace ns3
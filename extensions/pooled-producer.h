@@ -0,0 +1,107 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef NDN_POOLED_PRODUCER_H
+#define NDN_POOLED_PRODUCER_H
+
+#include "ns3/ndn-app.h"
+#include "ns3/ndn-name.h"
+#include "ns3/ndn-content-object.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/traced-callback.h"
+#include "ns3/nstime.h"
+
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+
+/**
+ * @brief Producer answering Interests from a pool of content objects built at start-up
+ *
+ * Replacement for Producer with BadContentRate that does not build a header, payload
+ * and packet per Interest.  StartApplication encodes PoolSize good (signature 0) and
+ * PoolSize bad (signature 1, as populated by cs::RankingTable) content objects with
+ * PayloadSize bytes of payload and Freshness, all sharing one payload buffer.  Every
+ * Interest is answered with a copy-on-write reference to the next object of the
+ * drawn kind, round robin.  When the Interest is for another name than the one the
+ * object was last served for, the object is replaced by a copy with that name and
+ * encoded again (a header and a packet, the payload buffer stays shared).  Only with
+ * a fixed name (MaxSeq 0) is no content allocated per Interest; with many names, e.g.
+ * a ConsumerPopulation zipf catalog, almost every Interest re-encodes an object.
+ * Headers are never modified once built, so trace sinks may keep them.
+ *
+ * Objects get distinct timestamps, and so distinct digests, when the pool is built.
+ * Digests of a kind repeat every PoolSize served objects, while Producer gives every
+ * object its own.
+ */
+class PooledProducer : public App
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  PooledProducer ();
+
+  /**
+   * @brief Draw bad content from the given ns-3 RNG stream instead of an automatically assigned one
+   * @returns number of streams used (1)
+   */
+  int64_t
+  AssignStreams (int64_t stream);
+
+  virtual void
+  OnInterest (Ptr<const Interest> interest, Ptr<Packet> packet);
+
+protected:
+  virtual void
+  StartApplication ();
+
+  virtual void
+  StopApplication ();
+
+private:
+  /**
+   * @brief Pre-built content object
+   */
+  struct Entry
+  {
+    Ptr<const ContentObject> header;
+    Ptr<Packet> packet;         ///< @brief encoded header, payload and tail
+  };
+
+  /**
+   * @brief Encode PoolSize objects with the given signature into pool
+   */
+  void
+  BuildPool (std::vector<Entry> &pool, uint32_t signature, Ptr<const Name> name);
+
+  /**
+   * @brief Encode the header of entry into its packet
+   */
+  void
+  Encode (Entry &entry);
+
+private:
+  std::vector<Entry> m_good;
+  std::vector<Entry> m_bad;
+  uint32_t m_nextGood;
+  uint32_t m_nextBad;
+  Ptr<const Packet> m_payload;
+
+  Ptr<UniformRandomVariable> m_random;
+
+  // Attributes
+  std::string m_prefix;
+  uint32_t m_payloadSize;
+  Time m_freshness;
+  double m_badContentRate;
+  uint32_t m_poolSize;
+
+  TracedCallback<Ptr<const ContentObject> > m_badContentTransmitted;
+};
+
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_POOLED_PRODUCER_H
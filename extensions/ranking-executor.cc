@@ -0,0 +1,161 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "ranking-executor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("RankingExecutor");
+
+namespace ns3 {
+
+RankingExecutor::RankingExecutor (const RankingParameters &params)
+  : m_params (params)
+  , m_topology (RankingTopology::Get (params.topology, params.starRouters))
+{
+  SetWorkerCount ();
+}
+
+RankingExecutor::RankingExecutor (const RankingParameters &params, const RankingTopology &topology)
+  : m_params (params)
+  , m_topology (topology)
+{
+  SetWorkerCount ();
+}
+
+void
+RankingExecutor::SetWorkerCount ()
+{
+  m_workers = m_params.workers;
+  if (m_workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      m_workers = cores > 0 ? static_cast<uint32_t> (cores) : 1;
+    }
+
+  if (m_params.confidenceHalfWidth > 0 && m_params.batchIterations == 0)
+    NS_FATAL_ERROR ("batchIterations must be positive with confidenceHalfWidth");
+
+  uint32_t batch = GetBatchIterations ();
+  if (m_workers > batch)
+    m_workers = std::max<uint32_t> (batch, 1);
+}
+
+uint32_t
+RankingExecutor::GetWorkerCount () const
+{
+  return m_workers;
+}
+
+uint32_t
+RankingExecutor::GetBatchIterations () const
+{
+  if (m_params.confidenceHalfWidth > 0)
+    return std::min (m_params.batchIterations, m_params.iterations);
+  else
+    return m_params.iterations;
+}
+
+void
+RankingExecutor::Run (RankingResults &results)
+{
+  while (results.iterations < m_params.iterations)
+    {
+      uint32_t iterations = std::min (GetBatchIterations (), m_params.iterations - results.iterations);
+      RunBatch (results.iterations, iterations, results);
+
+      if (m_params.confidenceHalfWidth > 0 && results.IsConverged (m_params))
+        break;
+    }
+}
+
+void
+RankingExecutor::RunBatch (uint32_t firstIteration, uint32_t iterations, RankingResults &results)
+{
+  NS_LOG_DEBUG ("Batch of iterations " << firstIteration << ".." << firstIteration + iterations - 1);
+
+  if (m_workers == 1)
+    {
+      RankingParameters params = m_params;
+      params.iterations = iterations;
+      RankingScenario (params, m_topology).Run (results, firstIteration);
+      return;
+    }
+
+  // Nothing buffered in the parent should be printed once per worker
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+
+  uint32_t workers = std::min (m_workers, iterations);
+  std::vector<pid_t> pids;
+  std::vector<int> fds;
+  for (uint32_t worker = 0; worker < workers; worker++)
+    {
+      uint32_t workerIterations = iterations / workers + (worker < iterations % workers ? 1 : 0);
+
+      int pipefd[2];
+      if (pipe (pipefd) != 0)
+        NS_FATAL_ERROR ("pipe () failed: " << strerror (errno));
+
+      pid_t pid = fork ();
+      if (pid < 0)
+        NS_FATAL_ERROR ("fork () failed: " << strerror (errno));
+
+      if (pid == 0)
+        {
+          close (pipefd[0]);
+          for (std::vector<int>::iterator fd = fds.begin (); fd != fds.end (); fd++)
+            close (*fd);
+
+          RunWorker (firstIteration, workerIterations, pipefd[1]);
+          _exit (0);
+        }
+
+      NS_LOG_DEBUG ("Worker " << worker << " (pid " << pid << "): iterations " << firstIteration
+                    << ".." << firstIteration + workerIterations - 1);
+      firstIteration += workerIterations;
+      close (pipefd[1]);
+      pids.push_back (pid);
+      fds.push_back (pipefd[0]);
+    }
+
+  // Drain every pipe before waiting, so that no worker blocks on a full pipe
+  for (uint32_t worker = 0; worker < workers; worker++)
+    {
+      RankingResults workerResults (m_params);
+      bool complete = workerResults.Read (fds[worker]);
+      close (fds[worker]);
+
+      int status = 0;
+      while (waitpid (pids[worker], &status, 0) < 0 && errno == EINTR)
+        ;
+      if (!complete || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        NS_FATAL_ERROR ("Worker " << worker << " (pid " << pids[worker] << ") failed");
+
+      results.Merge (workerResults);
+    }
+}
+
+void
+RankingExecutor::RunWorker (uint32_t firstIteration, uint32_t iterations, int fd)
+{
+  RankingParameters params = m_params;
+  params.iterations = iterations;
+
+  RankingResults results (params);
+  RankingScenario (params, m_topology).Run (results, firstIteration);
+
+  if (!results.Write (fd))
+    _exit (1);
+  close (fd);
+}
+
+} // namespace ns3
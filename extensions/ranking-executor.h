@@ -0,0 +1,78 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef RANKING_EXECUTOR_H
+#define RANKING_EXECUTOR_H
+
+#include "ranking-scenario.h"
+
+namespace ns3 {
+
+/**
+ * @brief Runs iterations of the ranking scenario in parallel worker processes
+ *
+ * Iterations are split evenly between RankingParameters::workers processes created
+ * with fork ().  Every worker runs a contiguous range of iterations, and iteration i
+ * uses ns-3 run number RngRun + i (see RankingScenario), so results do not depend on
+ * the number of workers.  Each worker sends its RankingResults back to the parent
+ * through a pipe, where they are merged.
+ *
+ * With a single worker, iterations are run in the calling process.
+ *
+ * With RankingParameters::confidenceHalfWidth, iterations are run in batches of
+ * RankingParameters::batchIterations (split between the workers) until the confidence
+ * intervals of all reported values are narrow enough or RankingParameters::iterations
+ * have been run.  Iterations are numbered continuously over the batches.
+ */
+class RankingExecutor
+{
+public:
+  RankingExecutor (const RankingParameters &params);
+
+  /**
+   * @brief Use an already loaded topology instead of RankingParameters::topology
+   */
+  RankingExecutor (const RankingParameters &params, const RankingTopology &topology);
+
+  /**
+   * @brief Run iterations until converged (or all of them) and merge the results of all workers into results
+   */
+  void
+  Run (RankingResults &results);
+
+  /**
+   * @brief Number of worker processes that will be used
+   */
+  uint32_t
+  GetWorkerCount () const;
+
+  /**
+   * @brief Number of iterations run between convergence checks
+   */
+  uint32_t
+  GetBatchIterations () const;
+
+private:
+  void
+  SetWorkerCount ();
+
+  /**
+   * @brief Run a batch of iterations, split between the workers
+   */
+  void
+  RunBatch (uint32_t firstIteration, uint32_t iterations, RankingResults &results);
+
+  /**
+   * @brief Body of worker process: run iterations firstIteration.. and write results to fd
+   */
+  void
+  RunWorker (uint32_t firstIteration, uint32_t iterations, int fd);
+
+private:
+  RankingParameters m_params;
+  RankingTopology m_topology;
+  uint32_t m_workers;
+};
+
+} // namespace ns3
+
+#endif // RANKING_EXECUTOR_H
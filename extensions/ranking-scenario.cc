@@ -0,0 +1,942 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "ranking-scenario.h"
+#include "consumer-trace-helper.h"
+#include "ranking-table.h"
+#include "consumer-population.h"
+
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndn-forwarding-strategy.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("RankingScenario");
+
+namespace ns3 {
+
+static double
+GetWallSeconds ()
+{
+  struct timeval now;
+  gettimeofday (&now, 0);
+  return now.tv_sec + now.tv_usec / 1000000.0;
+}
+
+template<class T>
+static std::string
+ToString (const T &value)
+{
+  std::ostringstream os;
+  os << value;
+  return os.str ();
+}
+
+RankingParameters::RankingParameters ()
+  : topology ("dfn")
+  , starRouters (5)
+  , consumersPerEdge (1)
+  , consumerPopulation (false)
+  , cachePlacement ("all")
+  , contentStore ("ns3::ndn::cs::Freshness::Lru")
+  , cacheImage ("")
+  , cacheImageTime (0)
+  , disableRanking (false)
+  , badConsumerRate (0.0)
+  , goodContentTimeout (100)
+  , badContentRate (0.95)
+  , badContentCount (100)
+  , populatedContentCount (0)
+  , goodContentCount (1)
+  , populatedContentFreshness (400)
+  , payloadSize (1024)
+  , frequency ("1")
+  , randomize ("none")
+  , catalogSize (0)
+  , zipfExponent (1.0)
+  , poisonedNames (1)
+  , consumerScheduling ("events")
+  , calendarTick ("1ms")
+  , totalDuration (400)
+  , earlyStop (true)
+  , quiescenceTimeout (0)
+  , iterations (1000)
+  , histogramStep (20)
+  , output ("hist")
+  , workers (1)
+  , snapshot (false)
+  , confidenceHalfWidth (0)
+  , confidenceAbsoluteHalfWidth (0.01)
+  , confidenceLevel (0.95)
+  , batchIterations (100)
+{
+}
+
+void
+RankingParameters::AddCommandLineArguments (CommandLine &cmd)
+{
+  cmd.AddValue ("topology", "Router topology: star, name of a file in topologies/ (dfn, att) or path to a topology file", topology);
+  cmd.AddValue ("starRouters", "Number of routers in the star topology", starRouters);
+  cmd.AddValue ("consumersPerEdge", "Number of consumers attached to each edge router", consumersPerEdge);
+  cmd.AddValue ("consumerPopulation", "Run the consumers of each edge router as one ConsumerPopulation on a single node", consumerPopulation);
+  cmd.AddValue ("cachePlacement", "Routers with populated caches: all or in", cachePlacement);
+  cmd.AddValue ("contentStore", "Content store of routers with populated caches, e.g. ns3::ndn::cs::RankingTable", contentStore);
+  cmd.AddValue ("cacheImage", "Path prefix of images of populated RankingTable caches, restored if present and captured otherwise", cacheImage);
+  cmd.AddValue ("cacheImageTime", "Simulation time at which missing cache images are captured, in seconds", cacheImageTime);
+
+  cmd.AddValue ("disableRanking", "Disable content ranking in routers", disableRanking);
+  cmd.AddValue ("badConsumerRate", "Fraction of malicious consumers", badConsumerRate);
+  cmd.AddValue ("goodContentTimeout", "ExclusionDiscardedTimeout, in seconds", goodContentTimeout);
+
+  cmd.AddValue ("badContentRate", "BadContentRate of populated caches (when populatedContentCount is 0)", badContentRate);
+  cmd.AddValue ("badContentCount", "BadContentCount of populated caches (when populatedContentCount is 0)", badContentCount);
+  cmd.AddValue ("populatedContentCount", "Number of content objects populated in each cache", populatedContentCount);
+  cmd.AddValue ("goodContentCount", "Number of good content objects among populated ones", goodContentCount);
+  cmd.AddValue ("populatedContentFreshness", "Freshness of populated content, in seconds", populatedContentFreshness);
+  cmd.AddValue ("payloadSize", "Payload size of populated content", payloadSize);
+
+  cmd.AddValue ("frequency", "Consumer Interest frequency", frequency);
+  cmd.AddValue ("randomize", "Consumer Interest randomization: none, uniform or exponential", randomize);
+  cmd.AddValue ("catalogSize", "Names /prefix/0 .. /prefix/<catalogSize - 1> requested with zipf popularity, 0 for only /prefix/0", catalogSize);
+  cmd.AddValue ("zipfExponent", "Exponent of the zipf popularity of catalog names", zipfExponent);
+  cmd.AddValue ("poisonedNames", "Number of most popular names populated in caches, /prefix/0 .. /prefix/<poisonedNames - 1>", poisonedNames);
+  cmd.AddValue ("consumerScheduling", "ConsumerPopulation Interest scheduling: events or calendar", consumerScheduling);
+  cmd.AddValue ("calendarTick", "ConsumerPopulation CalendarTick, e.g. 1ms, 0 for exact send times", calendarTick);
+
+  cmd.AddValue ("totalDuration", "Duration of each iteration, in seconds", totalDuration);
+  cmd.AddValue ("earlyStop", "End an iteration as soon as all good consumers stopped on good content", earlyStop);
+  cmd.AddValue ("quiescenceTimeout", "End an iteration once no consumer received content for this long, in seconds, 0 to disable", quiescenceTimeout);
+  cmd.AddValue ("iterations", "Number of iterations (maximum number with confidenceHalfWidth)", iterations);
+  cmd.AddValue ("histogramStep", "Histogram step, in seconds", histogramStep);
+  cmd.AddValue ("output", "Reported statistics: hist, stop or cdf", output);
+  cmd.AddValue ("snapshot", "Build the simulation once and fork () a copy for every iteration", snapshot);
+  cmd.AddValue ("workers", "Number of worker processes running iterations, 0 for one per core", workers);
+
+  cmd.AddValue ("confidenceHalfWidth", "Stop when confidence intervals of all reported values are within this fraction of their mean, 0 to run all iterations", confidenceHalfWidth);
+  cmd.AddValue ("confidenceAbsoluteHalfWidth", "Values whose confidence half-width is at most this, in their own unit, count as converged whatever their mean", confidenceAbsoluteHalfWidth);
+  cmd.AddValue ("confidenceLevel", "Confidence level of the intervals", confidenceLevel);
+  cmd.AddValue ("batchIterations", "Number of iterations run between convergence checks", batchIterations);
+}
+
+template<class T>
+static bool
+FromString (const std::string &str, T &value)
+{
+  std::istringstream is (str);
+  T parsed;
+  if (!(is >> parsed) || !is.eof ())
+    return false;
+  value = parsed;
+  return true;
+}
+
+static bool
+FromString (const std::string &str, bool &value)
+{
+  if (str == "true" || str == "1")
+    value = true;
+  else if (str == "false" || str == "0")
+    value = false;
+  else
+    return false;
+  return true;
+}
+
+static bool
+FromString (const std::string &str, std::string &value)
+{
+  value = str;
+  return true;
+}
+
+bool
+RankingParameters::Set (const std::string &name, const std::string &value)
+{
+  if (name == "topology") return FromString (value, topology);
+  if (name == "starRouters") return FromString (value, starRouters);
+  if (name == "consumersPerEdge") return FromString (value, consumersPerEdge);
+  if (name == "consumerPopulation") return FromString (value, consumerPopulation);
+  if (name == "cachePlacement") return FromString (value, cachePlacement);
+  if (name == "contentStore") return FromString (value, contentStore);
+  if (name == "cacheImage") return FromString (value, cacheImage);
+  if (name == "cacheImageTime") return FromString (value, cacheImageTime);
+  if (name == "disableRanking") return FromString (value, disableRanking);
+  if (name == "badConsumerRate") return FromString (value, badConsumerRate);
+  if (name == "goodContentTimeout") return FromString (value, goodContentTimeout);
+  if (name == "badContentRate") return FromString (value, badContentRate);
+  if (name == "badContentCount") return FromString (value, badContentCount);
+  if (name == "populatedContentCount") return FromString (value, populatedContentCount);
+  if (name == "goodContentCount") return FromString (value, goodContentCount);
+  if (name == "populatedContentFreshness") return FromString (value, populatedContentFreshness);
+  if (name == "payloadSize") return FromString (value, payloadSize);
+  if (name == "frequency") return FromString (value, frequency);
+  if (name == "randomize") return FromString (value, randomize);
+  if (name == "catalogSize") return FromString (value, catalogSize);
+  if (name == "zipfExponent") return FromString (value, zipfExponent);
+  if (name == "poisonedNames") return FromString (value, poisonedNames);
+  if (name == "consumerScheduling") return FromString (value, consumerScheduling);
+  if (name == "calendarTick") return FromString (value, calendarTick);
+  if (name == "totalDuration") return FromString (value, totalDuration);
+  if (name == "earlyStop") return FromString (value, earlyStop);
+  if (name == "quiescenceTimeout") return FromString (value, quiescenceTimeout);
+  if (name == "iterations") return FromString (value, iterations);
+  if (name == "histogramStep") return FromString (value, histogramStep);
+  if (name == "output") return FromString (value, output);
+  if (name == "confidenceHalfWidth") return FromString (value, confidenceHalfWidth);
+  if (name == "confidenceAbsoluteHalfWidth") return FromString (value, confidenceAbsoluteHalfWidth);
+  if (name == "confidenceLevel") return FromString (value, confidenceLevel);
+  if (name == "batchIterations") return FromString (value, batchIterations);
+  return false;
+}
+
+uint32_t
+RankingParameters::GetHistogramBins () const
+{
+  return std::max<uint32_t> (static_cast<uint32_t> (totalDuration / histogramStep), 1);
+}
+
+RankingResults::RankingResults (const RankingParameters &params)
+  : iterations (0)
+  , goodConsumerCount (0)
+  , stoppingMicroSeconds (0)
+  , setupSeconds (0)
+  , runSeconds (0)
+  , skippedSeconds (0)
+  , peakResidentKiloBytes (0)
+{
+  uint32_t bins = params.GetHistogramBins ();
+  badContentReceivedHist = metrics.AddHistogram ("BadContentReceived", bins);
+  goodContentReceivedHist = metrics.AddHistogram ("GoodContentReceived", bins);
+  contentReceivedHist = metrics.AddHistogram ("ReceivedContentObjects", bins);
+}
+
+void
+RankingResults::Merge (const RankingResults &other)
+{
+  iterations += other.iterations;
+  goodConsumerCount += other.goodConsumerCount;
+  metrics.Merge (other.metrics);
+
+  stoppingMicroSeconds += other.stoppingMicroSeconds;
+  statistics.Merge (other.statistics);
+  setupSeconds += other.setupSeconds;
+  runSeconds += other.runSeconds;
+  skippedSeconds += other.skippedSeconds;
+  peakResidentKiloBytes = std::max (peakResidentKiloBytes, other.peakResidentKiloBytes);
+
+  if (stoppingMicroSecondsCdf.size () < other.stoppingMicroSecondsCdf.size ())
+    stoppingMicroSecondsCdf.resize (other.stoppingMicroSecondsCdf.size (), 0);
+  for (size_t i = 0; i < other.stoppingMicroSecondsCdf.size (); i++)
+    stoppingMicroSecondsCdf[i] += other.stoppingMicroSecondsCdf[i];
+}
+
+void
+RankingResults::AddIteration (const RankingResults &iteration, const RankingParameters &params)
+{
+  std::vector<double> values;
+  iteration.GetReportedValues (params, values);
+  statistics.AddSamples (values);
+
+  Merge (iteration);
+}
+
+void
+RankingResults::GetReportedValues (const RankingParameters &params, std::vector<double> &values) const
+{
+  values.clear ();
+  if (iterations == 0)
+    return;
+
+  if (params.output == "hist")
+    {
+      // Per good consumer values are undefined when every consumer is malicious
+      if (goodConsumerCount == 0)
+        return;
+
+      for (uint32_t i = 0; i < metrics.GetBinCount (contentReceivedHist); i++)
+        {
+          values.push_back ((double)metrics.GetBin (contentReceivedHist, i) / goodConsumerCount);
+          values.push_back ((double)metrics.GetBin (badContentReceivedHist, i) / goodConsumerCount);
+          values.push_back ((double)metrics.GetBin (goodContentReceivedHist, i) / goodConsumerCount);
+        }
+    }
+  else if (params.output == "stop")
+    {
+      values.push_back ((double)stoppingMicroSeconds / iterations);
+    }
+  else if (params.output == "cdf")
+    {
+      for (size_t j = 0; j < stoppingMicroSecondsCdf.size (); j++)
+        values.push_back ((double)stoppingMicroSecondsCdf[j] / iterations);
+    }
+}
+
+bool
+RankingResults::IsConverged (const RankingParameters &params) const
+{
+  if (iterations < 2)
+    return false;
+
+  double z = SampleStatistics::GetQuantile (params.confidenceLevel);
+  return statistics.GetMaxRelativeHalfWidth (z, params.confidenceAbsoluteHalfWidth) <= params.confidenceHalfWidth;
+}
+
+void
+RankingResults::Print (std::ostream &os, const RankingParameters &params) const
+{
+  if (iterations == 0)
+    return;
+
+  if (params.output == "hist")
+    {
+      os << "-----------------------------------------------------------------------------------------" << std::endl;
+      os << "    Step        Content Received        Bad Content Received        Good Content Received" << std::endl;
+      os << "-----------------------------------------------------------------------------------------" << std::endl;
+
+      for (uint32_t i = 0; i < metrics.GetBinCount (contentReceivedHist); i++)
+        {
+          int64_t content = metrics.GetBin (contentReceivedHist, i);
+          int64_t bad = metrics.GetBin (badContentReceivedHist, i);
+          int64_t good = metrics.GetBin (goodContentReceivedHist, i);
+
+          os << std::fixed << std::setprecision (2);
+          os << std::setw (8) << i * params.histogramStep;
+          os << std::setw (24) << (double)content / goodConsumerCount;
+
+          std::ostringstream bad_received_str;
+          bad_received_str << std::fixed << std::setprecision (2) << (double)bad / goodConsumerCount
+                           << " (" << ((double)bad / content) * 100 << "%)";
+          os << std::setw (28) << bad_received_str.str ();
+
+          std::ostringstream good_received_str;
+          good_received_str << std::fixed << std::setprecision (2) << (double)good / goodConsumerCount
+                            << " (" << ((double)good / content) * 100 << "%)";
+          os << std::setw (29) << good_received_str.str ();
+          os << std::endl;
+        }
+      os << "-----------------------------------------------------------------------------------------" << std::endl;
+    }
+  else if (params.output == "stop")
+    {
+      os << "Max stopping microseconds: " << stoppingMicroSeconds / iterations << std::endl;
+    }
+  else if (params.output == "cdf")
+    {
+      uint32_t goodConsumersPerIteration = goodConsumerCount / iterations;
+
+      os << "Stopping microseconds: ";
+      for (uint32_t j = 0; j < goodConsumersPerIteration && j < stoppingMicroSecondsCdf.size (); j++)
+        {
+          os << ((double)(stoppingMicroSecondsCdf[j])) / iterations;
+          if (j < goodConsumersPerIteration - 1)
+            {
+              os << ", ";
+            }
+        }
+      os << std::endl;
+    }
+}
+
+static void
+SerializeVector (std::ostream &os, const std::vector<int64_t> &values)
+{
+  os << values.size ();
+  for (std::vector<int64_t>::const_iterator value = values.begin (); value != values.end (); value++)
+    os << " " << *value;
+  os << "\n";
+}
+
+static bool
+DeserializeVector (std::istream &is, std::vector<int64_t> &values)
+{
+  size_t size = 0;
+  if (!(is >> size))
+    return false;
+
+  values.assign (size, 0);
+  for (size_t i = 0; i < size; i++)
+    if (!(is >> values[i]))
+      return false;
+  return true;
+}
+
+void
+RankingResults::Serialize (std::ostream &os) const
+{
+  os << iterations << " " << goodConsumerCount << " " << stoppingMicroSeconds << "\n";
+  os << std::setprecision (17) << setupSeconds << " " << runSeconds << " " << skippedSeconds << " " << peakResidentKiloBytes << "\n";
+  metrics.Serialize (os);
+  SerializeVector (os, stoppingMicroSecondsCdf);
+  statistics.Serialize (os);
+}
+
+bool
+RankingResults::Deserialize (std::istream &is)
+{
+  uint32_t bins = metrics.GetBinCount (contentReceivedHist);
+  if (!(is >> iterations >> goodConsumerCount >> stoppingMicroSeconds >> setupSeconds >> runSeconds >> skippedSeconds >> peakResidentKiloBytes) ||
+      !metrics.Deserialize (is) ||
+      !DeserializeVector (is, stoppingMicroSecondsCdf) ||
+      !statistics.Deserialize (is))
+    return false;
+
+  // Offsets of the deserialized histograms may differ
+  badContentReceivedHist = metrics.AddHistogram ("BadContentReceived", bins);
+  goodContentReceivedHist = metrics.AddHistogram ("GoodContentReceived", bins);
+  contentReceivedHist = metrics.AddHistogram ("ReceivedContentObjects", bins);
+  return true;
+}
+
+bool
+RankingResults::Write (int fd) const
+{
+  std::ostringstream os;
+  Serialize (os);
+  std::string data = os.str ();
+
+  const char *buffer = data.c_str ();
+  size_t left = data.size ();
+  while (left > 0)
+    {
+      ssize_t size = write (fd, buffer, left);
+      if (size < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      buffer += size;
+      left -= size;
+    }
+  return true;
+}
+
+bool
+RankingResults::Read (int fd)
+{
+  std::string data;
+  char buffer[4096];
+  ssize_t size;
+  while ((size = read (fd, buffer, sizeof (buffer))) != 0)
+    {
+      if (size < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          return false;
+        }
+      data.append (buffer, size);
+    }
+
+  std::istringstream is (data);
+  return Deserialize (is);
+}
+
+void
+RankingResults::PrintTiming (std::ostream &os) const
+{
+  os << std::fixed << std::setprecision (3);
+  os << "Setup wall time: " << setupSeconds << " s, run wall time: " << runSeconds << " s";
+  if (iterations > 0)
+    os << " (" << setupSeconds / iterations << " s and " << runSeconds / iterations << " s per iteration)";
+  os << std::endl;
+  if (skippedSeconds > 0)
+    os << "Skipped simulated time: " << skippedSeconds << " s (" << skippedSeconds / iterations << " s per iteration)" << std::endl;
+  os << "Peak resident memory: " << peakResidentKiloBytes / 1024.0 << " MB" << std::endl;
+}
+
+void
+RankingResults::PrintConvergence (std::ostream &os, const RankingParameters &params) const
+{
+  double z = SampleStatistics::GetQuantile (params.confidenceLevel);
+  os << std::fixed << std::setprecision (2);
+  os << "Iterations: " << iterations << " of at most " << params.iterations
+     << ", largest " << params.confidenceLevel * 100 << "% confidence half-width: "
+     << statistics.GetMaxRelativeHalfWidth (z, params.confidenceAbsoluteHalfWidth) * 100 << "% of the mean"
+     << " (ignoring values known within " << params.confidenceAbsoluteHalfWidth << ")" << std::endl;
+}
+
+RankingScenario::RankingScenario (const RankingParameters &params)
+  : m_params (params)
+  , m_topology (RankingTopology::Get (params.topology, params.starRouters))
+  , m_run (RngSeedManager::GetRun ())
+  , m_histograms (Seconds (params.histogramStep), params.GetHistogramBins ())
+  , m_results (0)
+  , m_iterationGoodConsumerCount (0)
+{
+  Validate ();
+}
+
+RankingScenario::RankingScenario (const RankingParameters &params, const RankingTopology &topology)
+  : m_params (params)
+  , m_topology (topology)
+  , m_run (RngSeedManager::GetRun ())
+  , m_histograms (Seconds (params.histogramStep), params.GetHistogramBins ())
+  , m_results (0)
+  , m_iterationGoodConsumerCount (0)
+{
+  Validate ();
+}
+
+void
+RankingScenario::Validate () const
+{
+  if (m_params.output != "hist" && m_params.output != "stop" && m_params.output != "cdf")
+    NS_FATAL_ERROR ("Unknown output [" << m_params.output << "], expected hist, stop or cdf");
+
+  if (m_params.cachePlacement != "all" && m_params.cachePlacement != "in")
+    NS_FATAL_ERROR ("Unknown cache placement [" << m_params.cachePlacement << "], expected all or in");
+
+  if (m_topology.GetEdgeRouters ().empty ())
+    NS_FATAL_ERROR ("Topology [" << m_params.topology << "] does not define edge routers");
+
+  if (m_params.cachePlacement == "in" && m_topology.GetInnerRouters ().empty ())
+    NS_FATAL_ERROR ("Topology [" << m_params.topology << "] does not define inner routers");
+
+  // RankingTable only recognizes digest components (GetDigestComponent) in Exclude
+  // filters, which only ConsumerPopulation is known to put there
+  if (m_params.contentStore == "ns3::ndn::cs::RankingTable" && !m_params.consumerPopulation)
+    NS_FATAL_ERROR ("contentStore=ns3::ndn::cs::RankingTable needs consumerPopulation");
+
+  if (!m_params.cacheImage.empty () && m_params.contentStore != "ns3::ndn::cs::RankingTable")
+    NS_FATAL_ERROR ("cacheImage requires contentStore ns3::ndn::cs::RankingTable");
+
+  if (m_params.cacheImageTime < 0 || m_params.cacheImageTime > m_params.totalDuration)
+    NS_FATAL_ERROR ("cacheImageTime must be within totalDuration");
+
+  if (m_params.consumerScheduling != "events" && m_params.consumerScheduling != "calendar")
+    NS_FATAL_ERROR ("Unknown consumer scheduling [" << m_params.consumerScheduling << "], expected events or calendar");
+  if (m_params.consumerScheduling == "calendar" && !m_params.consumerPopulation)
+    NS_FATAL_ERROR ("consumerScheduling=calendar needs consumerPopulation");
+
+  if (m_params.catalogSize > 0 && !m_params.consumerPopulation)
+    NS_FATAL_ERROR ("catalogSize needs consumerPopulation");
+  if (m_params.zipfExponent < 0)
+    NS_FATAL_ERROR ("zipfExponent must not be negative");
+  if (m_params.poisonedNames == 0 || m_params.poisonedNames > std::max<uint32_t> (m_params.catalogSize, 1))
+    NS_FATAL_ERROR ("poisonedNames must be between 1 and catalogSize");
+  if (m_params.poisonedNames > 1 && m_params.contentStore != "ns3::ndn::cs::RankingTable")
+    NS_FATAL_ERROR ("poisonedNames needs contentStore=ns3::ndn::cs::RankingTable");
+
+  if (m_params.quiescenceTimeout < 0)
+    NS_FATAL_ERROR ("quiescenceTimeout must not be negative");
+}
+
+uint32_t
+RankingScenario::GetConsumerCount () const
+{
+  return m_topology.GetEdgeRouters ().size () * m_params.consumersPerEdge;
+}
+
+void
+RankingScenario::SetBuiltCallback (Callback<void, const NodeContainer &> callback)
+{
+  m_builtCallback = callback;
+}
+
+uint32_t
+RankingScenario::GetConsumerNodeCount () const
+{
+  return m_params.consumerPopulation ? m_topology.GetEdgeRouters ().size () : GetConsumerCount ();
+}
+
+void
+RankingScenario::Run (RankingResults &results, uint32_t firstIteration)
+{
+  if (m_params.snapshot)
+    RunSnapshots (results, firstIteration);
+  else
+    {
+      for (uint32_t it = 0; it < m_params.iterations; it++)
+        {
+          RunIteration (results, firstIteration + it);
+        }
+    }
+
+  RngSeedManager::SetRun (m_run);
+}
+
+void
+RankingScenario::RunIteration (RankingResults &results, uint32_t it)
+{
+  RankingResults iteration (m_params);
+  RngSeedManager::SetRun (m_run + it);
+
+  double start = GetWallSeconds ();
+  Build ();
+  AssignConsumerRoles (iteration);
+  iteration.setupSeconds += GetWallSeconds () - start;
+
+  Simulate (iteration);
+  results.AddIteration (iteration, m_params);
+}
+
+void
+RankingScenario::RunSnapshots (RankingResults &results, uint32_t firstIteration)
+{
+  double start = GetWallSeconds ();
+  Build ();
+  results.setupSeconds += GetWallSeconds () - start;
+
+  // Nothing buffered in the parent should be printed once per iteration
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+
+  for (uint32_t it = 0; it < m_params.iterations; it++)
+    {
+      int pipefd[2];
+      if (pipe (pipefd) != 0)
+        NS_FATAL_ERROR ("pipe () failed: " << strerror (errno));
+
+      pid_t pid = fork ();
+      if (pid < 0)
+        NS_FATAL_ERROR ("fork () failed: " << strerror (errno));
+
+      if (pid == 0)
+        {
+          // Copy-on-write child: everything is already built, switch to the run of the iteration
+          close (pipefd[0]);
+          RngSeedManager::SetRun (m_run + firstIteration + it);
+
+          RankingResults childResults (m_params);
+          AssignConsumerRoles (childResults);
+          Simulate (childResults);
+          _exit (childResults.Write (pipefd[1]) ? 0 : 1);
+        }
+
+      close (pipefd[1]);
+      RankingResults childResults (m_params);
+      bool complete = childResults.Read (pipefd[0]);
+      close (pipefd[0]);
+
+      int status = 0;
+      while (waitpid (pid, &status, 0) < 0 && errno == EINTR)
+        ;
+      if (!complete || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+        NS_FATAL_ERROR ("Iteration " << firstIteration + it << " (pid " << pid << ") failed");
+
+      results.AddIteration (childResults, m_params);
+    }
+
+  // The parent never runs the prepared simulation
+  Simulator::Destroy ();
+  m_consumers = ApplicationContainer ();
+}
+
+void
+RankingScenario::Build ()
+{
+  // Creating nodes
+  NodeContainer nodes;
+  nodes.Create (GetConsumerNodeCount () + m_topology.GetRouterCount ());
+
+  InstallLinks (nodes);
+  InstallStacks (nodes);
+  InstallConsumers (nodes);
+
+  if (!m_builtCallback.IsNull ())
+    m_builtCallback (nodes);
+}
+
+void
+RankingScenario::Simulate (RankingResults &results)
+{
+  m_results = &results;
+  m_earliestStoppingMicroSeconds = static_cast<int64_t> (m_params.totalDuration * 1000000);  // Max simulation time
+  m_stoppedConsumerCount = 0;
+
+  double start = GetWallSeconds ();
+
+  if (m_params.output == "hist")
+    m_histograms.Start ();
+
+  // Only good consumers stopping on good content report stopping
+  uint32_t expectedStops = m_params.earlyStop && m_params.output != "hist" ? m_iterationGoodConsumerCount : 0;
+  // Missing cache images are captured at cacheImageTime
+  Time notBefore = m_params.cacheImage.empty () ? Seconds (0) : Seconds (m_params.cacheImageTime);
+  m_completion.Start (Seconds (m_params.totalDuration), expectedStops, Seconds (m_params.quiescenceTimeout), notBefore);
+
+  // Run simulation
+  Simulator::Stop (Seconds (m_params.totalDuration));
+  Simulator::Run ();
+  results.skippedSeconds += m_completion.GetSkippedTime ().GetSeconds ();
+  Simulator::Destroy ();
+  m_consumers = ApplicationContainer ();
+
+  results.runSeconds += GetWallSeconds () - start;
+
+  // ru_maxrss is a high-water mark, so it still covers the populated caches
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    results.peakResidentKiloBytes = std::max (results.peakResidentKiloBytes, usage.ru_maxrss);
+
+  results.stoppingMicroSeconds += m_earliestStoppingMicroSeconds;
+  results.iterations++;
+
+  m_results = 0;
+}
+
+void
+RankingScenario::InstallLinks (const NodeContainer &nodes)
+{
+  uint32_t consumers = GetConsumerNodeCount ();
+  const std::vector<uint32_t> &edgeRouters = m_topology.GetEdgeRouters ();
+  uint32_t consumersPerNode = m_params.consumerPopulation ? 1 : m_params.consumersPerEdge;
+
+  PointToPointHelper p2p;
+  // Connecting consumers to edge routers
+  for (uint32_t i = 0; i < consumers; i++)
+    {
+      p2p.Install (nodes.Get (i), nodes.Get (consumers + edgeRouters[i / consumersPerNode]));
+    }
+
+  // Connecting routers, every link is listed in the adjacency of both its ends
+  const std::vector<uint32_t> &offsets = m_topology.GetOffsets ();
+  const std::vector<uint32_t> &adjacency = m_topology.GetAdjacency ();
+  for (uint32_t router = 0; router < m_topology.GetRouterCount (); router++)
+    {
+      for (uint32_t i = offsets[router]; i < offsets[router + 1]; i++)
+        {
+          if (router < adjacency[i])
+            p2p.Install (nodes.Get (consumers + router), nodes.Get (consumers + adjacency[i]));
+        }
+    }
+}
+
+void
+RankingScenario::InstallStacks (const NodeContainer &nodes)
+{
+  uint32_t consumers = GetConsumerNodeCount ();
+
+  std::vector<bool> cached (m_topology.GetRouterCount (), m_params.cachePlacement == "all");
+  if (m_params.cachePlacement == "in")
+    {
+      const std::vector<uint32_t> &inner = m_topology.GetInnerRouters ();
+      for (std::vector<uint32_t>::const_iterator router = inner.begin (); router != inner.end (); router++)
+        cached[*router] = true;
+    }
+
+  // Install CCNx with cache on (inner) routers
+  ndn::StackHelper ccnxHelperWithCache;
+  ccnxHelperWithCache.SetDefaultRoutes (true);
+  ccnxHelperWithCache.SetContentStore (m_params.contentStore, "MaxSize", "0",
+                                       "ExclusionDiscardedTimeout", ToString (m_params.goodContentTimeout),
+                                       "DisableRanking", m_params.disableRanking ? "true" : "false");
+  ccnxHelperWithCache.SetContentStoreAttribute ("BadContentName", "/prefix/0");
+  if (m_params.poisonedNames > 1)
+    ccnxHelperWithCache.SetContentStoreAttribute ("BadContentNames", "/prefix/0.." + ToString (m_params.poisonedNames - 1));
+  ccnxHelperWithCache.SetContentStoreAttribute ("BadContentFreshness", ToString (m_params.populatedContentFreshness));
+  ccnxHelperWithCache.SetContentStoreAttribute ("BadContentPayloadSize", ToString (m_params.payloadSize));
+  if (m_params.populatedContentCount == 0)
+    {
+      ccnxHelperWithCache.SetContentStoreAttribute ("BadContentCount", ToString (m_params.badContentCount));
+      ccnxHelperWithCache.SetContentStoreAttribute ("BadContentRate", ToString (m_params.badContentRate));
+    }
+
+  // Install CCNx without cache on consumers and the remaining routers
+  std::ostringstream max_uint32_t;
+  max_uint32_t << (sizeof(uint32_t) * 256) - 1;
+
+  ndn::StackHelper ccnxHelperNoCache;
+  ccnxHelperNoCache.SetDefaultRoutes (true);
+  ccnxHelperNoCache.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", max_uint32_t.str ());
+
+  for (uint32_t i = 0; i < m_topology.GetRouterCount (); i++)
+    {
+      Ptr<Node> router = nodes.Get (consumers + i);
+      if (!cached[i])
+        {
+          ccnxHelperNoCache.Install (router);
+          continue;
+        }
+
+      ccnxHelperWithCache.Install (router);
+      Ptr<ndn::ContentStore> store = router->GetObject<ndn::ContentStore> ();
+
+      // The forwarder looks up the store without the incoming face, reported just before
+      Ptr<ndn::cs::RankingTable> rankingTable = DynamicCast<ndn::cs::RankingTable> (store);
+      if (rankingTable &&
+          !router->GetObject<ndn::ForwardingStrategy> ()->TraceConnectWithoutContext (
+            "InInterests", MakeCallback (&ndn::cs::RankingTable::NotifyIncomingInterest, rankingTable)))
+        NS_FATAL_ERROR ("Forwarding strategy has no InInterests trace source");
+
+      std::string image = m_params.cacheImage + "." + ToString (i);
+      if (!m_params.cacheImage.empty () && access (image.c_str (), R_OK) == 0)
+        {
+          DynamicCast<ndn::cs::RankingTable> (store)->Restore (image);
+          continue;
+        }
+
+      if (m_params.populatedContentCount == 0)
+        store->Populate ();
+      else
+        store->Populate (m_params.populatedContentCount, m_params.goodContentCount);
+
+      if (!m_params.cacheImage.empty ())
+        {
+          Ptr<ndn::cs::RankingTable> table = DynamicCast<ndn::cs::RankingTable> (store);
+          if (m_params.cacheImageTime == 0)
+            table->Save (image);
+          else
+            Simulator::Schedule (Seconds (m_params.cacheImageTime), &ndn::cs::RankingTable::Save, table, image);
+        }
+    }
+
+  for (uint32_t i = 0; i < consumers; i++)
+    {
+      ccnxHelperNoCache.Install (nodes.Get (i));
+    }
+}
+
+void
+RankingScenario::InstallConsumers (const NodeContainer &nodes)
+{
+  ndn::AppHelper consumerHelper (m_params.consumerPopulation ? "ns3::ndn::ConsumerPopulation" : "ns3::ndn::ConsumerCbr");
+  // Consumer will request /prefix/0, /prefix/1, ... up to /prefix/<MaxSeq>
+  consumerHelper.SetPrefix ("/prefix");
+  consumerHelper.SetAttribute ("Frequency", StringValue (m_params.frequency));
+  consumerHelper.SetAttribute ("MaxSeq", StringValue ("0"));
+  consumerHelper.SetAttribute ("Repeat", BooleanValue (true));
+  consumerHelper.SetAttribute ("ExclusionRate", DoubleValue (0.0));
+  consumerHelper.SetAttribute ("DisableExclusion", BooleanValue (false));
+  if (m_params.consumerPopulation)
+    {
+      consumerHelper.SetAttribute ("Consumers", UintegerValue (m_params.consumersPerEdge));
+      consumerHelper.SetAttribute ("Scheduling", StringValue (m_params.consumerScheduling));
+      consumerHelper.SetAttribute ("CalendarTick", StringValue (m_params.calendarTick));
+      if (m_params.catalogSize > 0)
+        {
+          consumerHelper.SetAttribute ("Popularity", StringValue ("zipf"));
+          consumerHelper.SetAttribute ("CatalogSize", UintegerValue (m_params.catalogSize));
+          consumerHelper.SetAttribute ("ZipfExponent", DoubleValue (m_params.zipfExponent));
+        }
+    }
+
+  m_consumers = ApplicationContainer ();
+  for (uint32_t i = 0; i < GetConsumerNodeCount (); i++)
+    {
+      m_consumers.Add (consumerHelper.Install (nodes.Get (i)));
+    }
+}
+
+void
+RankingScenario::AssignConsumerRoles (RankingResults &results)
+{
+  bool stopOnGoodContent = m_params.output != "hist";
+  m_histograms.Attach (&results.metrics);
+
+  Ptr<UniformRandomVariable> roles = CreateObject<UniformRandomVariable> ();
+  roles->SetStream (ROLES_STREAM);
+  int64_t populationStream = POPULATION_STREAM;
+  uint32_t goodConsumerCount = results.goodConsumerCount;
+
+  for (uint32_t i = 0; i < m_consumers.GetN (); i++)
+    {
+      Ptr<Application> consumer = m_consumers.Get (i);
+
+      // (Re)creates the consumer's random variable from the current seed and run
+      consumer->SetAttribute ("Randomize", StringValue (m_params.randomize));
+
+      if (m_params.quiescenceTimeout > 0)
+        ConsumerTraceHelper::ConnectReceivedContentObjects (consumer, MakeCallback (&RankingScenario::ContentReceived, this));
+
+      Ptr<ndn::ConsumerPopulation> population = DynamicCast<ndn::ConsumerPopulation> (consumer);
+      if (population)
+        {
+          AssignPopulationRoles (population, roles, populationStream++, results);
+          continue;
+        }
+
+      double r = roles->GetValue ();
+      bool malicious = m_params.badConsumerRate != 0 && r <= m_params.badConsumerRate;
+      consumer->SetAttribute ("Malicious", BooleanValue (malicious));
+      if (malicious)
+        continue;
+
+      results.goodConsumerCount++;
+      if (stopOnGoodContent)
+        consumer->SetAttribute ("StopOnGoodContent", BooleanValue (true));
+
+      if (stopOnGoodContent)
+        {
+          ConsumerTraceHelper::ConnectStoppedOnGoodContent (consumer, MakeCallback (&RankingScenario::StoppedOnGoodContent, this));
+        }
+      else
+        {
+          m_histograms.CountTrace (consumer, "BadContentReceived", results.badContentReceivedHist);
+          m_histograms.CountTrace (consumer, "GoodContentReceived", results.goodContentReceivedHist);
+          m_histograms.CountTrace (consumer, "ReceivedContentObjects", results.contentReceivedHist);
+        }
+    }
+
+  m_iterationGoodConsumerCount = results.goodConsumerCount - goodConsumerCount;
+}
+
+void
+RankingScenario::AssignPopulationRoles (Ptr<ndn::ConsumerPopulation> population, Ptr<UniformRandomVariable> roles,
+                                        int64_t stream, RankingResults &results)
+{
+  bool stopOnGoodContent = m_params.output != "hist";
+
+  // Randomize has just recreated the population's random variable, which would
+  // otherwise get a stream number depending on what the process created before
+  population->AssignStreams (stream);
+
+  // Same draws, in the same order, as for one ConsumerCbr per consumer
+  for (uint32_t i = 0; i < population->GetN (); i++)
+    {
+      double r = roles->GetValue ();
+      bool malicious = m_params.badConsumerRate != 0 && r <= m_params.badConsumerRate;
+      population->SetMalicious (i, malicious);
+      population->SetStopOnGoodContent (i, !malicious && stopOnGoodContent);
+      population->SetTraced (i, !malicious);
+      if (!malicious)
+        results.goodConsumerCount++;
+    }
+
+  if (stopOnGoodContent)
+    {
+      ConsumerTraceHelper::ConnectConsumerStoppedOnGoodContent (population, MakeCallback (&RankingScenario::StoppedOnGoodContent, this));
+    }
+  else
+    {
+      m_histograms.CountTrace (population, "ConsumerBadContentReceived", results.badContentReceivedHist);
+      m_histograms.CountTrace (population, "ConsumerGoodContentReceived", results.goodContentReceivedHist);
+      m_histograms.CountTrace (population, "ConsumerReceivedContentObjects", results.contentReceivedHist);
+    }
+}
+
+void
+RankingScenario::StoppedOnGoodContent (uint32_t node, Ptr<const ndn::ContentObject> content, Time stoppingTime)
+{
+  if (stoppingTime.GetMicroSeconds () < m_earliestStoppingMicroSeconds)
+    m_earliestStoppingMicroSeconds = stoppingTime.GetMicroSeconds ();
+
+  if (m_results->stoppingMicroSecondsCdf.size () <= m_stoppedConsumerCount)
+    m_results->stoppingMicroSecondsCdf.resize (m_stoppedConsumerCount + 1, 0);
+  m_results->stoppingMicroSecondsCdf[m_stoppedConsumerCount] += stoppingTime.GetMicroSeconds ();
+  m_stoppedConsumerCount++;
+
+  m_completion.NotifyStopped ();
+}
+
+void
+RankingScenario::ContentReceived (uint32_t node, Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet,
+                                  Ptr<ndn::App> app, Ptr<ndn::Face> face)
+{
+  m_completion.NotifyActivity ();
+}
+
+} // namespace ns3
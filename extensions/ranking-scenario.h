@@ -0,0 +1,346 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef RANKING_SCENARIO_H
+#define RANKING_SCENARIO_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "completion-monitor.h"
+#include "consumer-population.h"
+#include "metrics-registry.h"
+#include "ranking-topology.h"
+#include "sample-statistics.h"
+#include "time-histogram-collector.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Runtime parameters of the ranking scenario
+ *
+ * Each field replaces one of the #defines of the hard-coded scenarios in
+ * scenarios/NDSS and scenarios/SENT.  Defaults correspond to
+ * dfn-fresh-populate-bc0.95-bCr0.0-hist-WR.
+ */
+struct RankingParameters
+{
+  RankingParameters ();
+
+  /**
+   * @brief Register all parameters as command line arguments
+   */
+  void
+  AddCommandLineArguments (CommandLine &cmd);
+
+  /**
+   * @brief Set a parameter by its command line name (e.g., "badConsumerRate")
+   * @returns false if there is no such parameter or value cannot be parsed
+   */
+  bool
+  Set (const std::string &name, const std::string &value);
+
+  /**
+   * @brief Number of histogram steps in totalDuration
+   */
+  uint32_t
+  GetHistogramBins () const;
+
+  std::string topology;          ///< @brief star, dfn, att or path to a topology file (see RankingTopology::Get)
+  uint32_t starRouters;          ///< @brief number of routers in the star topology
+  uint32_t consumersPerEdge;     ///< @brief consumers attached to each edge router
+  bool consumerPopulation;       ///< @brief run the consumers of an edge router as one ConsumerPopulation node
+  std::string cachePlacement;    ///< @brief all (every router) or in (inner routers only)
+  std::string contentStore;      ///< @brief content store policy of routers with populated caches
+  std::string cacheImage;        ///< @brief path prefix of RankingTable images of populated caches, empty for none
+  double cacheImageTime;         ///< @brief simulation time at which missing images are captured, in seconds
+
+  bool disableRanking;           ///< @brief DISABLE_RANKING
+  double badConsumerRate;        ///< @brief BAD_CONSUMER_RATE
+  double goodContentTimeout;     ///< @brief GOOD_CONTENT_TIMEOUT, in seconds (ExclusionDiscardedTimeout)
+
+  // Bad content in routers
+  double badContentRate;         ///< @brief BAD_CONTENT_RATE (used when populatedContentCount is 0)
+  uint32_t badContentCount;      ///< @brief BAD_CONTENT_COUNT (used when populatedContentCount is 0)
+  uint32_t populatedContentCount; ///< @brief POPULATED_CONTENT_COUNT, 0 to populate using BadContentRate/Count
+  uint32_t goodContentCount;     ///< @brief GOOD_CONTENT_COUNT
+  double populatedContentFreshness; ///< @brief BAD_CONTENT_FRESHNESS/POPULATED_CONTENT_FRESHNESS, in seconds
+  uint32_t payloadSize;          ///< @brief BadContentPayloadSize
+
+  std::string frequency;         ///< @brief consumer Frequency
+  std::string randomize;         ///< @brief consumer Randomize
+  uint32_t catalogSize;          ///< @brief ConsumerPopulation zipf CatalogSize, 0 to request /prefix/0 only
+  double zipfExponent;           ///< @brief ConsumerPopulation ZipfExponent
+  uint32_t poisonedNames;        ///< @brief populated names, the most popular ones of the catalog
+  std::string consumerScheduling; ///< @brief ConsumerPopulation Scheduling: events or calendar
+  std::string calendarTick;      ///< @brief ConsumerPopulation CalendarTick
+
+  double totalDuration;          ///< @brief TOTAL_DURATION, in seconds
+  bool earlyStop;                ///< @brief end stop and cdf iterations once all good consumers stopped
+  double quiescenceTimeout;      ///< @brief end iterations after this long without received content, 0 to disable
+  uint32_t iterations;           ///< @brief ITERATIONS, upper bound when confidenceHalfWidth is set
+  double histogramStep;          ///< @brief HISTOGRAM_STEP, in seconds
+  std::string output;            ///< @brief hist, stop or cdf
+  uint32_t workers;              ///< @brief number of worker processes, 0 for one per core
+  bool snapshot;                 ///< @brief build once, fork () a copy-on-write child per iteration
+
+  // Adaptive number of iterations
+  double confidenceHalfWidth;    ///< @brief target half-width relative to the mean, 0 to run all iterations
+  double confidenceAbsoluteHalfWidth; ///< @brief half-width under which a value is converged whatever its mean
+  double confidenceLevel;        ///< @brief confidence level of the interval
+  uint32_t batchIterations;      ///< @brief iterations run between convergence checks
+};
+
+/**
+ * @brief Results accumulated over the iterations of the ranking scenario
+ */
+struct RankingResults
+{
+  RankingResults (const RankingParameters &params);
+
+  /**
+   * @brief Add up results of another (independent) set of iterations
+   */
+  void
+  Merge (const RankingResults &other);
+
+  /**
+   * @brief Merge results of a single iteration and record its reported values as samples
+   */
+  void
+  AddIteration (const RankingResults &iteration, const RankingParameters &params);
+
+  /**
+   * @brief Values printed by Print, in the order they are printed
+   *
+   * hist: content, bad and good content per good consumer of every bin;
+   * stop: earliest stopping time; cdf: average i-th stopping times.
+   */
+  void
+  GetReportedValues (const RankingParameters &params, std::vector<double> &values) const;
+
+  /**
+   * @brief Whether every reported value is known within params.confidenceHalfWidth
+   */
+  bool
+  IsConverged (const RankingParameters &params) const;
+
+  /**
+   * @brief Print results in the format of the original scenarios
+   */
+  void
+  Print (std::ostream &os, const RankingParameters &params) const;
+
+  /**
+   * @brief Write results in a form that can be read back by Deserialize
+   */
+  void
+  Serialize (std::ostream &os) const;
+
+  /**
+   * @brief Read results written by Serialize (replaces current values)
+   * @returns false if the stream does not contain complete results
+   */
+  bool
+  Deserialize (std::istream &is);
+
+  /**
+   * @brief Serialize results into a file descriptor (e.g., a pipe)
+   */
+  bool
+  Write (int fd) const;
+
+  /**
+   * @brief Deserialize results from a file descriptor, reading until end of file
+   */
+  bool
+  Read (int fd);
+
+  /**
+   * @brief Print setup and run wall time, and peak resident memory
+   */
+  void
+  PrintTiming (std::ostream &os) const;
+
+  /**
+   * @brief Print number of iterations run and the largest relative confidence half-width
+   */
+  void
+  PrintConvergence (std::ostream &os, const RankingParameters &params) const;
+
+  uint32_t iterations;
+  uint32_t goodConsumerCount;    ///< @brief good consumers summed over all iterations
+
+  // hist output
+  MetricsRegistry metrics;
+  MetricsRegistry::HistogramId badContentReceivedHist;
+  MetricsRegistry::HistogramId goodContentReceivedHist;
+  MetricsRegistry::HistogramId contentReceivedHist;
+
+  // stop output
+  int64_t stoppingMicroSeconds;  ///< @brief sum of the earliest stopping time of each iteration
+
+  // cdf output
+  std::vector<int64_t> stoppingMicroSecondsCdf; ///< @brief sum of i-th stopping time of each iteration
+
+  SampleStatistics statistics;   ///< @brief per-iteration reported values
+
+  double setupSeconds;           ///< @brief wall time spent building simulations
+  double runSeconds;             ///< @brief wall time spent running simulations
+  double skippedSeconds;         ///< @brief simulated time not run because iterations completed early
+  long peakResidentKiloBytes;    ///< @brief largest peak resident set size of the processes running iterations
+};
+
+/**
+ * @brief Parameterized version of the populated-cache ranking scenarios
+ *
+ * Builds the topology, installs the NDN stack with populated (poisoned) caches on
+ * routers and ConsumerCbr applications on consumers, and collects the statistics
+ * selected by RankingParameters::output.
+ *
+ * Node layout: consumer nodes get node ids 0..C-1, routers C..C+R-1.  With
+ * RankingParameters::consumerPopulation there is one consumer node per edge router,
+ * running a ConsumerPopulation of consumersPerEdge logical consumers; roles are
+ * drawn in the same order either way, so both layouts get the same malicious consumers.
+ *
+ * Iteration i (counted over all workers and batches, see Run) uses ns-3 run number
+ * RngRun + i, and consumer roles are drawn from the explicitly assigned stream
+ * ROLES_STREAM of that run.  Roles of an iteration therefore do not depend on which
+ * process runs it or in which order.  Random variables created by ndnSIM itself use
+ * automatically assigned streams, and are reproducible for the same workers and
+ * snapshot settings.
+ *
+ * With RankingParameters::snapshot the topology, stacks, populated caches and
+ * applications are built only once.  Every iteration then runs in a fork ()ed
+ * copy-on-write child that only switches to the run number of the iteration, draws
+ * the consumer roles and runs the simulation.  Populated cache contents are
+ * therefore identical in all iterations.
+ */
+class RankingScenario
+{
+public:
+  RankingScenario (const RankingParameters &params);
+
+  /**
+   * @brief Use an already loaded topology instead of RankingParameters::topology
+   */
+  RankingScenario (const RankingParameters &params, const RankingTopology &topology);
+
+  /**
+   * @brief Explicit stream of the random variable drawing consumer roles
+   */
+  static const int64_t ROLES_STREAM = 0;
+
+  /**
+   * @brief Explicit stream of the first ConsumerPopulation, the next ones use the following streams
+   */
+  static const int64_t POPULATION_STREAM = 1;
+
+  /**
+   * @brief Run all configured iterations
+   * @param firstIteration index of the first iteration among all iterations of the experiment
+   */
+  void
+  Run (RankingResults &results, uint32_t firstIteration = 0);
+
+  /**
+   * @brief Build, run and destroy a single simulation
+   */
+  void
+  RunIteration (RankingResults &results, uint32_t iteration);
+
+  /**
+   * @brief Build the simulation once and run every iteration in a forked child
+   */
+  void
+  RunSnapshots (RankingResults &results, uint32_t firstIteration);
+
+  uint32_t
+  GetConsumerCount () const;
+
+  /**
+   * @brief Function called with all nodes once a simulation is built, before it runs
+   *
+   * E.g., to connect trace sinks of a benchmark.  Without snapshot, iterations run in
+   * the calling process, so the sinks see every iteration.
+   */
+  void
+  SetBuiltCallback (Callback<void, const NodeContainer &> callback);
+
+private:
+  /**
+   * @brief Number of nodes running consumer applications
+   */
+  uint32_t
+  GetConsumerNodeCount () const;
+
+  /**
+   * @brief Create nodes, links, stacks and consumer applications
+   */
+  void
+  Build ();
+
+  /**
+   * @brief Choose malicious consumers and connect trace sinks of the good ones
+   */
+  void
+  AssignConsumerRoles (RankingResults &results);
+
+  /**
+   * @brief Choose the malicious logical consumers of population and connect to its good ones
+   */
+  void
+  AssignPopulationRoles (Ptr<ndn::ConsumerPopulation> population, Ptr<UniformRandomVariable> roles,
+                         int64_t stream, RankingResults &results);
+
+  /**
+   * @brief Run and destroy the built simulation, accumulating into results
+   */
+  void
+  Simulate (RankingResults &results);
+
+  void
+  InstallLinks (const NodeContainer &nodes);
+
+  void
+  InstallStacks (const NodeContainer &nodes);
+
+  void
+  InstallConsumers (const NodeContainer &nodes);
+
+  void
+  StoppedOnGoodContent (uint32_t node, Ptr<const ndn::ContentObject> content, Time stoppingTime);
+
+  void
+  ContentReceived (uint32_t node, Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet,
+                   Ptr<ndn::App> app, Ptr<ndn::Face> face);
+
+  /**
+   * @brief Abort the program if parameters or topology are not usable
+   */
+  void
+  Validate () const;
+
+private:
+  RankingParameters m_params;
+  RankingTopology m_topology;
+  uint32_t m_run;                ///< @brief run number of the first iteration
+  ApplicationContainer m_consumers;
+  TimeHistogramCollector m_histograms;
+  CompletionMonitor m_completion;
+  Callback<void, const NodeContainer &> m_builtCallback;
+
+  // state of the current iteration
+  RankingResults *m_results;
+  int64_t m_earliestStoppingMicroSeconds;
+  uint32_t m_stoppedConsumerCount;
+  uint32_t m_iterationGoodConsumerCount;
+};
+
+} // namespace ns3
+
+#endif // RANKING_SCENARIO_H
@@ -0,0 +1,316 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "ranking-sweep.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("RankingSweep");
+
+namespace ns3 {
+
+namespace {
+
+/**
+ * @brief Process running a grid point, with its output read so far
+ */
+struct Child
+{
+  pid_t pid;
+  uint32_t point;
+  std::string data;
+};
+
+} // namespace
+
+RankingSweep::RankingSweep (const RankingParameters &params, const std::string &grid)
+  : m_params (params)
+  , m_topology (RankingTopology::Get (params.topology, params.starRouters))
+  , m_workers (params.workers)
+{
+  std::istringstream is (grid);
+  std::string spec;
+  while (std::getline (is, spec, ';'))
+    {
+      if (spec.empty ())
+        continue;
+      m_dimensions.push_back (ParseDimension (spec));
+
+      // Check values early, rather than in a child process
+      RankingParameters check = m_params;
+      const Dimension &dimension = m_dimensions.back ();
+      for (std::vector<std::string>::const_iterator value = dimension.values.begin (); value != dimension.values.end (); value++)
+        {
+          if (!check.Set (dimension.name, *value))
+            NS_FATAL_ERROR ("Invalid sweep parameter [" << dimension.name << "=" << *value << "]");
+        }
+      if (dimension.name == "topology" || dimension.name == "starRouters")
+        NS_FATAL_ERROR ("Cannot sweep over [" << dimension.name << "], the topology is shared by all points");
+      if (dimension.name == "output")
+        NS_FATAL_ERROR ("Cannot sweep over [output], all points are printed in one table");
+    }
+
+  if (m_workers == 0)
+    {
+      long cores = sysconf (_SC_NPROCESSORS_ONLN);
+      m_workers = cores > 0 ? static_cast<uint32_t> (cores) : 1;
+    }
+}
+
+RankingSweep::Dimension
+RankingSweep::ParseDimension (const std::string &spec)
+{
+  Dimension dimension;
+  size_t equals = spec.find ('=');
+  if (equals == std::string::npos || equals == 0 || equals + 1 == spec.size ())
+    NS_FATAL_ERROR ("Invalid sweep dimension [" << spec << "], expected name=values");
+
+  dimension.name = spec.substr (0, equals);
+  std::string values = spec.substr (equals + 1);
+
+  double start, step, end;
+  char colon1, colon2;
+  std::istringstream range (values);
+  if (values.find (':') != std::string::npos)
+    {
+      if (!(range >> start >> colon1 >> step >> colon2 >> end) || colon1 != ':' || colon2 != ':' || !range.eof () ||
+          step <= 0 || end < start)
+        NS_FATAL_ERROR ("Invalid sweep range [" << values << "], expected start:step:end");
+
+      // Tolerate rounding of the last value (e.g., 0:0.1:1)
+      uint32_t count = static_cast<uint32_t> (std::floor ((end - start) / step + 1e-9)) + 1;
+      for (uint32_t i = 0; i < count; i++)
+        {
+          std::ostringstream value;
+          value << start + i * step;
+          dimension.values.push_back (value.str ());
+        }
+    }
+  else
+    {
+      std::istringstream list (values);
+      std::string value;
+      while (std::getline (list, value, ','))
+        dimension.values.push_back (value);
+    }
+
+  if (dimension.values.empty ())
+    NS_FATAL_ERROR ("Sweep dimension [" << spec << "] has no values");
+  return dimension;
+}
+
+uint32_t
+RankingSweep::GetPointCount () const
+{
+  uint32_t count = 1;
+  for (std::vector<Dimension>::const_iterator dimension = m_dimensions.begin (); dimension != m_dimensions.end (); dimension++)
+    count *= dimension->values.size ();
+  return count;
+}
+
+RankingParameters
+RankingSweep::GetPoint (uint32_t point) const
+{
+  RankingParameters params = m_params;
+  for (size_t i = m_dimensions.size (); i-- > 0; )
+    {
+      const Dimension &dimension = m_dimensions[i];
+      params.Set (dimension.name, dimension.values[point % dimension.values.size ()]);
+      point /= dimension.values.size ();
+    }
+  return params;
+}
+
+void
+RankingSweep::Run (std::ostream &os)
+{
+  uint32_t points = GetPointCount ();
+  std::vector<RankingResults> results;
+  for (uint32_t point = 0; point < points; point++)
+    results.push_back (RankingResults (GetPoint (point)));
+
+  std::map<int, Child> running;
+
+  // Nothing buffered in the parent should be printed once per point
+  os.flush ();
+  std::cout.flush ();
+  std::cerr.flush ();
+  fflush (0);
+
+  uint32_t next = 0;
+  while (next < points || !running.empty ())
+    {
+      // Keep m_workers grid points running
+      while (next < points && running.size () < m_workers)
+        {
+          int pipefd[2];
+          if (pipe (pipefd) != 0)
+            NS_FATAL_ERROR ("pipe () failed: " << strerror (errno));
+
+          pid_t pid = fork ();
+          if (pid < 0)
+            NS_FATAL_ERROR ("fork () failed: " << strerror (errno));
+
+          if (pid == 0)
+            {
+              close (pipefd[0]);
+              for (std::map<int, Child>::iterator child = running.begin (); child != running.end (); child++)
+                close (child->first);
+
+              RunPoint (next, pipefd[1]);
+              _exit (0);
+            }
+
+          NS_LOG_DEBUG ("Point " << next << " (pid " << pid << ")");
+          close (pipefd[1]);
+          Child &child = running[pipefd[0]];
+          child.pid = pid;
+          child.point = next;
+          next++;
+        }
+
+      // Collect output of whichever points produce it
+      std::vector<struct pollfd> fds;
+      for (std::map<int, Child>::iterator child = running.begin (); child != running.end (); child++)
+        {
+          struct pollfd fd;
+          fd.fd = child->first;
+          fd.events = POLLIN;
+          fd.revents = 0;
+          fds.push_back (fd);
+        }
+
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          if (errno == EINTR)
+            continue;
+          NS_FATAL_ERROR ("poll () failed: " << strerror (errno));
+        }
+
+      for (std::vector<struct pollfd>::iterator fd = fds.begin (); fd != fds.end (); fd++)
+        {
+          if (fd->revents == 0)
+            continue;
+
+          Child &child = running[fd->fd];
+          char buffer[4096];
+          ssize_t size = read (fd->fd, buffer, sizeof (buffer));
+          if (size < 0 && errno == EINTR)
+            continue;
+          if (size > 0)
+            {
+              child.data.append (buffer, size);
+              continue;
+            }
+
+          // End of file (or error): the point is done
+          close (fd->fd);
+          int status = 0;
+          while (waitpid (child.pid, &status, 0) < 0 && errno == EINTR)
+            ;
+
+          std::istringstream is (child.data);
+          if (size < 0 || !results[child.point].Deserialize (is) || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+            NS_FATAL_ERROR ("Point " << child.point << " (pid " << child.pid << ") failed");
+
+          running.erase (fd->fd);
+        }
+    }
+
+  PrintHeader (os);
+  for (uint32_t point = 0; point < points; point++)
+    PrintPoint (os, point, results[point]);
+}
+
+void
+RankingSweep::RunPoint (uint32_t point, int fd)
+{
+  RankingParameters params = GetPoint (point);
+  // Points already run in parallel
+  params.workers = 1;
+
+  RankingExecutor executor (params, m_topology);
+  RankingResults results (params);
+  executor.Run (results);
+
+  if (!results.Write (fd))
+    _exit (1);
+  close (fd);
+}
+
+void
+RankingSweep::PrintHeader (std::ostream &os) const
+{
+  os << "#";
+  for (std::vector<Dimension>::const_iterator dimension = m_dimensions.begin (); dimension != m_dimensions.end (); dimension++)
+    os << dimension->name << "\t";
+  os << "Iterations\t";
+
+  if (m_params.output == "hist")
+    os << "Step\tContentReceived\tBadContentReceived\tGoodContentReceived";
+  else if (m_params.output == "stop")
+    os << "StoppingMicroSeconds";
+  else if (m_params.output == "cdf")
+    os << "Consumer\tStoppingMicroSeconds";
+  os << std::endl;
+}
+
+void
+RankingSweep::PrintPoint (std::ostream &os, uint32_t point, const RankingResults &results) const
+{
+  if (results.iterations == 0)
+    return;
+
+  RankingParameters params = GetPoint (point);
+  std::vector<double> values;
+  results.GetReportedValues (params, values);
+
+  // Values of the point, decoded in the same order as GetPoint
+  std::vector<std::string> pointValues (m_dimensions.size ());
+  for (size_t i = m_dimensions.size (), index = point; i-- > 0; )
+    {
+      const Dimension &dimension = m_dimensions[i];
+      pointValues[i] = dimension.values[index % dimension.values.size ()];
+      index /= dimension.values.size ();
+    }
+
+  std::ostringstream prefix;
+  for (size_t i = 0; i < pointValues.size (); i++)
+    prefix << pointValues[i] << "\t";
+  prefix << results.iterations << "\t";
+
+  os << std::fixed << std::setprecision (2);
+  if (params.output == "hist")
+    {
+      for (size_t i = 0; i + 2 < values.size (); i += 3)
+        {
+          os << prefix.str () << (i / 3) * params.histogramStep << "\t"
+             << values[i] << "\t" << values[i + 1] << "\t" << values[i + 2] << std::endl;
+        }
+    }
+  else if (params.output == "stop")
+    {
+      os << prefix.str () << values[0] << std::endl;
+    }
+  else if (params.output == "cdf")
+    {
+      // Same points as RankingResults::Print
+      uint32_t goodConsumersPerIteration = results.goodConsumerCount / results.iterations;
+      for (uint32_t j = 0; j < goodConsumersPerIteration && j < values.size (); j++)
+        os << prefix.str () << j << "\t" << values[j] << std::endl;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,84 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef RANKING_SWEEP_H
+#define RANKING_SWEEP_H
+
+#include "ranking-executor.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Runs the ranking scenario for every point of a parameter grid
+ *
+ * The grid is given as dimensions separated by ';', each dimension is a parameter
+ * name (as accepted by RankingParameters::Set) followed by either a list of values or
+ * a numeric range:
+ *
+ *   badConsumerRate=0:0.1:1;disableRanking=false,true
+ *
+ * The parameters that map to ContentStore and ConsumerCbr attributes are
+ * badContentRate, badContentCount, goodContentTimeout (ExclusionDiscardedTimeout),
+ * disableRanking, badConsumerRate (Malicious ratio) and frequency, but any other
+ * parameter except topology, starRouters and output can be swept as well.
+ *
+ * The topology is loaded once and shared by all grid points.  Grid points are run in
+ * fork ()ed children, at most RankingParameters::workers (0 for one per core) at the
+ * same time, each running its iterations in-process.  All points start from the same
+ * ns-3 seed and run number, so they are compared on common random numbers.
+ */
+class RankingSweep
+{
+public:
+  RankingSweep (const RankingParameters &params, const std::string &grid);
+
+  uint32_t
+  GetPointCount () const;
+
+  /**
+   * @brief Parameters of a grid point, the last dimension varies fastest
+   */
+  RankingParameters
+  GetPoint (uint32_t point) const;
+
+  /**
+   * @brief Run all grid points and print one combined table
+   */
+  void
+  Run (std::ostream &os);
+
+private:
+  struct Dimension
+  {
+    std::string name;
+    std::vector<std::string> values;
+  };
+
+  static Dimension
+  ParseDimension (const std::string &spec);
+
+  /**
+   * @brief Body of the child process running a grid point
+   */
+  void
+  RunPoint (uint32_t point, int fd);
+
+  void
+  PrintHeader (std::ostream &os) const;
+
+  void
+  PrintPoint (std::ostream &os, uint32_t point, const RankingResults &results) const;
+
+private:
+  RankingParameters m_params;
+  RankingTopology m_topology;
+  std::vector<Dimension> m_dimensions;
+  uint32_t m_workers;
+};
+
+} // namespace ns3
+
+#endif // RANKING_SWEEP_H
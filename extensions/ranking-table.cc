@@ -0,0 +1,1604 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "ranking-table.h"
+
+#include "ns3/buffer.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/enum.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("ndn.cs.RankingTable");
+
+static uint64_t g_digestComputations = 0;
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * @brief Continues a 64-bit FNV-1a over the given bytes
+ */
+static inline uint64_t
+Fnv1a (uint64_t hash, const uint8_t *data, uint32_t size)
+{
+  for (const uint8_t *byte = data; byte != data + size; byte++)
+    {
+      hash ^= *byte;
+      hash *= FNV_PRIME;
+    }
+  return hash;
+}
+
+/**
+ * @brief Digest index position before masking; digests are hashes already, only spread them
+ */
+static inline uint32_t
+IndexHash (uint64_t digest)
+{
+  return static_cast<uint32_t> ((digest * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+namespace ns3 {
+namespace ndn {
+namespace cs {
+
+NS_OBJECT_ENSURE_REGISTERED (RankingTable);
+
+TypeId
+RankingTable::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::ndn::cs::RankingTable")
+    .SetGroupName ("Ndn")
+    .SetParent<ContentStore> ()
+    .AddConstructor<RankingTable> ()
+
+    .AddAttribute ("MaxSize",
+                   "Maximum number of cached versions, 0 for unlimited",
+                   StringValue ("100"),
+                   MakeUintegerAccessor (&RankingTable::m_maxSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ExclusionDiscardedTimeout",
+                   "Time after which exclusions of a version are forgotten, in seconds",
+                   StringValue ("100"),
+                   MakeDoubleAccessor (&RankingTable::m_exclusionDiscardedTimeout),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("ExpiryTick",
+                   "Resolution of exclusion and freshness expiry: the period of the timing wheel event",
+                   StringValue ("1s"),
+                   MakeTimeAccessor (&RankingTable::m_expiryTick),
+                   MakeTimeChecker ())
+    .AddAttribute ("DisableRanking",
+                   "Return the most recently added non-excluded version instead of the best ranked one",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RankingTable::m_disableRanking),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RankingEngine",
+                   "How the best version is found: scan re-evaluates every version per lookup, "
+                   "heap keeps versions in an incrementally maintained rank order",
+                   EnumValue (SCAN),
+                   MakeEnumAccessor (&RankingTable::m_engine),
+                   MakeEnumChecker (SCAN, "scan",
+                                    HEAP, "heap"))
+    .AddAttribute ("ExclusionAccounting",
+                   "How exclusions are accounted per face: exact keeps a count per excluding face, "
+                   "sketch a fixed-size FaceSketch per version",
+                   EnumValue (EXACT),
+                   MakeEnumAccessor (&RankingTable::m_accounting),
+                   MakeEnumChecker (EXACT, "exact",
+                                    SKETCH, "sketch"))
+    .AddAttribute ("FaceSketchRegisters",
+                   "Distinct-face registers per version in sketch mode, a power of two from 16",
+                   StringValue ("16"),
+                   MakeUintegerAccessor (&RankingTable::m_faceSketchRegisters),
+                   MakeUintegerChecker<uint32_t> (16, 65536))
+    .AddAttribute ("FaceSketchWidth",
+                   "Count-min counters per row and version in sketch mode",
+                   StringValue ("8"),
+                   MakeUintegerAccessor (&RankingTable::m_faceSketchWidth),
+                   MakeUintegerChecker<uint32_t> (1))
+
+    .AddAttribute ("BadContentName", "Name of populated content",
+                   StringValue ("/prefix/0"),
+                   MakeStringAccessor (&RankingTable::m_badContentName),
+                   MakeStringChecker ())
+    .AddAttribute ("BadContentNames",
+                   "Comma-separated names of populated content, instead of BadContentName when not empty; "
+                   "<prefix>/<first>..<last> stands for every sequence number from first to last",
+                   StringValue (""),
+                   MakeStringAccessor (&RankingTable::m_badContentNames),
+                   MakeStringChecker ())
+    .AddAttribute ("BadContentFreshness", "Freshness of populated content, in seconds (0 never expires)",
+                   StringValue ("0"),
+                   MakeDoubleAccessor (&RankingTable::m_badContentFreshness),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("BadContentPayloadSize", "Payload size of populated content",
+                   StringValue ("1024"),
+                   MakeUintegerAccessor (&RankingTable::m_badContentPayloadSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BadContentCount", "Number of versions added by Populate ()",
+                   StringValue ("100"),
+                   MakeUintegerAccessor (&RankingTable::m_badContentCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BadContentRate", "Fraction of bad versions added by Populate ()",
+                   StringValue ("0.95"),
+                   MakeDoubleAccessor (&RankingTable::m_badContentRate),
+                   MakeDoubleChecker<double> (0, 1))
+
+    .AddTraceSource ("Exclusions", "Exclusion of a cached version (digest) by an Interest received on a face",
+                     MakeTraceSourceAccessor (&RankingTable::m_exclusionsTrace))
+    ;
+
+  return tid;
+}
+
+RankingTable::RankingTable ()
+  : m_size (0)
+  , m_sequence (0)
+  , m_incomingFace (0)
+  , m_nextTableId (0)
+{
+}
+
+RankingTable::~RankingTable ()
+{
+}
+
+void
+RankingTable::DoDispose ()
+{
+  m_tickEvent.Cancel ();
+  m_wheel.Clear ();
+
+  // Populated versions only own their table arrays, so this frees them wholesale
+  m_tableIds.clear ();
+  m_tables.clear ();
+  m_size = 0;
+  m_incomingInterest = 0;
+
+  ContentStore::DoDispose ();
+}
+
+RankingTable::VersionTable::VersionTable ()
+  : id (0)
+  , indexed (false)
+  , ranked (true)
+  , sketched (false)
+{
+}
+
+uint32_t
+RankingTable::VersionTable::GetSize () const
+{
+  return exclusions.size ();
+}
+
+void
+RankingTable::VersionTable::Reserve (uint32_t count)
+{
+  exclusions.reserve (count);
+  lastExclusion.reserve (count);
+  excludingFaces.reserve (count);
+  expiration.reserve (count);
+  sequence.reserve (count);
+  digests.reserve (count);
+  headers.reserve (count);
+  payloads.reserve (count);
+  timestamps.reserve (count);
+  signatures.reserve (count);
+  if (indexed)
+    {
+      heap.reserve (count);
+      heapPosition.reserve (count);
+    }
+  if (sketched)
+    {
+      faceRegisters.reserve (static_cast<size_t> (count) * sketch.GetRegisterCount ());
+      faceCounters.reserve (static_cast<size_t> (count) * sketch.GetCounterCount ());
+    }
+
+  uint32_t positions = 16;
+  while (positions < 2 * count)
+    positions *= 2;
+  if (positions > index.size ())
+    Rehash (positions);
+}
+
+int32_t
+RankingTable::VersionTable::Find (uint64_t digest) const
+{
+  if (index.empty ())
+    return -1;
+  return static_cast<int32_t> (index[Probe (digest)]) - 1;
+}
+
+uint32_t
+RankingTable::VersionTable::Probe (uint64_t digest) const
+{
+  // Linear probing, the index is at most half full
+  uint32_t mask = index.size () - 1;
+  uint32_t position = IndexHash (digest) & mask;
+  while (index[position] != 0 && digests[index[position] - 1] != digest)
+    position = (position + 1) & mask;
+  return position;
+}
+
+void
+RankingTable::VersionTable::Rehash (uint32_t positions)
+{
+  index.assign (positions, 0);
+  for (uint32_t slot = 0; slot < GetSize (); slot++)
+    index[Probe (digests[slot])] = slot + 1;
+}
+
+bool
+RankingTable::VersionTable::Before (uint32_t a, uint32_t b) const
+{
+  if (ranked && excludingFaces[a] != excludingFaces[b])
+    return excludingFaces[a] < excludingFaces[b];
+  if (ranked && exclusions[a] != exclusions[b])
+    return exclusions[a] < exclusions[b];
+  return sequence[a] > sequence[b];
+}
+
+void
+RankingTable::VersionTable::SiftUp (uint32_t position)
+{
+  uint32_t slot = heap[position];
+  while (position > 0)
+    {
+      uint32_t parent = (position - 1) / 2;
+      if (!Before (slot, heap[parent]))
+        break;
+      heap[position] = heap[parent];
+      heapPosition[heap[position]] = position;
+      position = parent;
+    }
+  heap[position] = slot;
+  heapPosition[slot] = position;
+}
+
+void
+RankingTable::VersionTable::SiftDown (uint32_t position)
+{
+  uint32_t slot = heap[position];
+  uint32_t size = heap.size ();
+  while (2 * position + 1 < size)
+    {
+      uint32_t child = 2 * position + 1;
+      if (child + 1 < size && Before (heap[child + 1], heap[child]))
+        child++;
+      if (!Before (heap[child], slot))
+        break;
+      heap[position] = heap[child];
+      heapPosition[heap[position]] = position;
+      position = child;
+    }
+  heap[position] = slot;
+  heapPosition[slot] = position;
+}
+
+void
+RankingTable::VersionTable::BuildHeap ()
+{
+  heap.clear ();
+  heapPosition.assign (GetSize (), 0);
+  for (uint32_t slot = 0; slot < GetSize (); slot++)
+    {
+      heap.push_back (slot);
+      SiftUp (slot);
+    }
+}
+
+bool
+RankingTable::VersionTable::IsHeapValid () const
+{
+  uint32_t size = GetSize ();
+  if (heap.size () != size || heapPosition.size () != size)
+    return false;
+
+  for (uint32_t position = 0; position < size; position++)
+    {
+      // A permutation of the slots, consistent with heapPosition, in heap order
+      if (heap[position] >= size || heapPosition[heap[position]] != position)
+        return false;
+      if (position > 0 && Before (heap[position], heap[(position - 1) / 2]))
+        return false;
+    }
+  return true;
+}
+
+void
+RankingTable::VersionTable::UpdateRank (uint32_t slot)
+{
+  SiftUp (heapPosition[slot]);
+  SiftDown (heapPosition[slot]);
+}
+
+void
+RankingTable::VersionTable::AccountExclusion (uint32_t slot, uint32_t faceId)
+{
+  if (sketched)
+    {
+      uint8_t *registers = &faceRegisters[static_cast<size_t> (slot) * sketch.GetRegisterCount ()];
+      sketch.Add (registers, &faceCounters[static_cast<size_t> (slot) * sketch.GetCounterCount ()], faceId);
+      excludingFaces[slot] = sketch.EstimateFaces (registers);
+      return;
+    }
+
+  FaceExclusions &faces = faceExclusions[digests[slot]];
+  FaceExclusions::iterator face = std::lower_bound (faces.begin (), faces.end (), std::make_pair (faceId, 0u));
+  if (face != faces.end () && face->first == faceId)
+    face->second++;
+  else
+    faces.insert (face, std::make_pair (faceId, 1u));
+  excludingFaces[slot] = faces.size ();
+}
+
+void
+RankingTable::VersionTable::ResetExclusions (uint32_t slot)
+{
+  exclusions[slot] = 0;
+  excludingFaces[slot] = 0;
+
+  if (sketched)
+    {
+      std::fill_n (faceRegisters.begin () + static_cast<size_t> (slot) * sketch.GetRegisterCount (),
+                   sketch.GetRegisterCount (), 0);
+      std::fill_n (faceCounters.begin () + static_cast<size_t> (slot) * sketch.GetCounterCount (),
+                   sketch.GetCounterCount (), 0);
+    }
+  else
+    faceExclusions.erase (digests[slot]);
+}
+
+void
+RankingTable::VersionTable::Append (uint64_t digest, Ptr<const ContentObject> header, Ptr<const Packet> payload,
+                                    double expirationTime, uint64_t sequenceNumber, Time timestamp, uint32_t signature)
+{
+  exclusions.push_back (0);
+  lastExclusion.push_back (-std::numeric_limits<double>::infinity ());
+  excludingFaces.push_back (0);
+  expiration.push_back (expirationTime);
+  sequence.push_back (sequenceNumber);
+  digests.push_back (digest);
+
+  headers.push_back (header);
+  payloads.push_back (payload);
+  timestamps.push_back (timestamp);
+  signatures.push_back (signature);
+  if (sketched)
+    {
+      faceRegisters.resize (faceRegisters.size () + sketch.GetRegisterCount (), 0);
+      faceCounters.resize (faceCounters.size () + sketch.GetCounterCount (), 0);
+    }
+
+  uint32_t slot = GetSize () - 1;
+  if (2 * GetSize () > index.size ())
+    Rehash (std::max<uint32_t> (16, 2 * index.size ()));
+  else
+    index[Probe (digest)] = slot + 1;
+
+  if (indexed)
+    {
+      heap.push_back (slot);
+      heapPosition.push_back (slot);
+      SiftUp (slot);
+    }
+}
+
+void
+RankingTable::VersionTable::Remove (uint32_t slot)
+{
+  uint32_t last = GetSize () - 1;
+
+  if (!sketched && exclusions[slot] != 0)
+    faceExclusions.erase (digests[slot]);
+
+  // Backward-shift deletion, so that no probe sequence is cut by the freed position
+  uint32_t mask = index.size () - 1;
+  uint32_t hole = Probe (digests[slot]);
+  index[hole] = 0;
+  for (uint32_t position = (hole + 1) & mask; index[position] != 0; position = (position + 1) & mask)
+    {
+      uint32_t home = IndexHash (digests[index[position] - 1]) & mask;
+      if (((position - home) & mask) >= ((position - hole) & mask))
+        {
+          index[hole] = index[position];
+          index[position] = 0;
+          hole = position;
+        }
+    }
+
+  if (indexed)
+    {
+      // Take the slot out of the heap while all slots are still in place...
+      uint32_t position = heapPosition[slot];
+      uint32_t moved = heap.back ();
+      heap.pop_back ();
+      if (moved != slot)
+        {
+          heap[position] = moved;
+          heapPosition[moved] = position;
+          UpdateRank (moved);
+        }
+
+      // ...then let the heap follow the last slot to its new place
+      if (slot != last)
+        {
+          heap[heapPosition[last]] = slot;
+          heapPosition[slot] = heapPosition[last];
+        }
+      heapPosition.pop_back ();
+    }
+
+  if (slot != last)
+    {
+      index[Probe (digests[last])] = slot + 1;
+      exclusions[slot] = exclusions[last];
+      lastExclusion[slot] = lastExclusion[last];
+      excludingFaces[slot] = excludingFaces[last];
+      expiration[slot] = expiration[last];
+      sequence[slot] = sequence[last];
+      digests[slot] = digests[last];
+      headers[slot] = headers[last];
+      payloads[slot] = payloads[last];
+      timestamps[slot] = timestamps[last];
+      signatures[slot] = signatures[last];
+      if (sketched)
+        {
+          uint32_t registers = sketch.GetRegisterCount ();
+          uint32_t counters = sketch.GetCounterCount ();
+          std::copy (faceRegisters.begin () + static_cast<size_t> (last) * registers, faceRegisters.end (),
+                     faceRegisters.begin () + static_cast<size_t> (slot) * registers);
+          std::copy (faceCounters.begin () + static_cast<size_t> (last) * counters, faceCounters.end (),
+                     faceCounters.begin () + static_cast<size_t> (slot) * counters);
+        }
+    }
+
+  exclusions.pop_back ();
+  lastExclusion.pop_back ();
+  excludingFaces.pop_back ();
+  expiration.pop_back ();
+  sequence.pop_back ();
+  digests.pop_back ();
+  headers.pop_back ();
+  payloads.pop_back ();
+  timestamps.pop_back ();
+  signatures.pop_back ();
+  if (sketched)
+    {
+      faceRegisters.resize (faceRegisters.size () - sketch.GetRegisterCount ());
+      faceCounters.resize (faceCounters.size () - sketch.GetCounterCount ());
+    }
+}
+
+/**
+ * @brief Shared payload of one size and the FNV-1a multiplier of its (zero) bytes
+ */
+struct SharedPayload
+{
+  Ptr<const Packet> packet;
+  uint64_t multiplier;
+};
+
+static std::map<uint32_t, SharedPayload> &
+GetSharedPayloads ()
+{
+  // Never destroyed, so that no packet outlives the ns-3 packet machinery at exit
+  static std::map<uint32_t, SharedPayload> *payloads = new std::map<uint32_t, SharedPayload> ();
+  return *payloads;
+}
+
+Ptr<const Packet>
+RankingTable::GetSharedPayload (uint32_t size)
+{
+  SharedPayload &payload = GetSharedPayloads ()[size];
+  if (!payload.packet)
+    {
+      payload.packet = Create<Packet> (size);
+
+      // XOR with a zero byte is a no-op, hashing the payload is one multiplication
+      payload.multiplier = 1;
+      for (uint32_t i = 0; i < size; i++)
+        payload.multiplier *= FNV_PRIME;
+    }
+  return payload.packet;
+}
+
+uint64_t
+RankingTable::ComputeDigest (const ContentObject &header, const Packet &payload)
+{
+  g_digestComputations++;
+  return GetDigest (header, payload);
+}
+
+uint64_t
+RankingTable::GetDigest (const ContentObject &header, const Packet &payload)
+{
+  // Scratch buffers reused by all calls, never destroyed (see GetSharedPayloads)
+  static Buffer *encoded = new Buffer ();
+  static std::vector<uint8_t> *bytes = new std::vector<uint8_t> ();
+
+  uint32_t headerSize = header.GetSerializedSize ();
+  encoded->AddAtStart (headerSize);
+  header.Serialize (encoded->Begin ());
+  uint64_t hash = Fnv1a (FNV_OFFSET, encoded->PeekData (), headerSize);
+  encoded->RemoveAtStart (headerSize);
+
+  std::map<uint32_t, SharedPayload> &shared = GetSharedPayloads ();
+  std::map<uint32_t, SharedPayload>::const_iterator cached = shared.find (payload.GetSize ());
+  if (cached != shared.end () && PeekPointer (cached->second.packet) == &payload)
+    return hash * cached->second.multiplier;
+
+  if (bytes->size () < payload.GetSize ())
+    bytes->resize (payload.GetSize ());
+  if (payload.GetSize () > 0)
+    payload.CopyData (&(*bytes)[0], payload.GetSize ());
+  return Fnv1a (hash, bytes->empty () ? 0 : &(*bytes)[0], payload.GetSize ());
+}
+
+uint64_t
+RankingTable::GetDigestComputations ()
+{
+  return g_digestComputations;
+}
+
+name::Component
+RankingTable::GetDigestComponent (const ContentObject &header, const Packet &payload)
+{
+  return ExcludeMatcher::MakeComponent (GetDigest (header, payload));
+}
+
+int32_t
+RankingTable::Select (VersionTable &table, Ptr<const Interest> interest, uint32_t faceId)
+{
+  double now = Simulator::Now ().GetSeconds ();
+
+  // Stale versions are left for the timing wheel to remove, only skip them here
+  uint32_t size = table.GetSize ();
+  m_excluded.assign (size, 0);
+
+  Ptr<const Exclude> exclude = interest->GetExclude ();
+  if (exclude)
+    {
+      for (uint32_t slot = 0; slot < size; slot++)
+        {
+          if (!m_matcher.IsExcluded (table.digests[slot]) &&
+              !(m_matcher.HasRanges () && exclude->isExcluded (ExcludeMatcher::MakeComponent (table.digests[slot]))))
+            continue;
+
+          m_excluded[slot] = 1;
+          if (!m_disableRanking && table.expiration[slot] > now)
+            RecordExclusion (table, slot, interest, faceId, now);
+        }
+    }
+
+  // Linear scan over the packed arrays, in the rank order of the heap engine
+  int32_t best = -1;
+  for (uint32_t slot = 0; slot < size; slot++)
+    {
+      if (m_excluded[slot] || table.expiration[slot] <= now)
+        continue;
+
+      if (best < 0 || table.Before (slot, best))
+        best = slot;
+    }
+
+  // SelectIndexed expects a clean scratch space
+  m_excluded.clear ();
+  return best;
+}
+
+int32_t
+RankingTable::SelectIndexed (VersionTable &table, Ptr<const Interest> interest, uint32_t faceId)
+{
+  double now = Simulator::Now ().GetSeconds ();
+
+  uint32_t size = table.GetSize ();
+  if (m_excluded.size () < size)
+    m_excluded.resize (size, 0);
+
+  // Only the excluded versions are visited, looked up by digest
+  m_marked.clear ();
+  Ptr<const Exclude> exclude = interest->GetExclude ();
+  if (exclude)
+    {
+      const std::vector<uint64_t> &digests = m_matcher.GetDigests ();
+      for (std::vector<uint64_t>::const_iterator digest = digests.begin (); digest != digests.end (); digest++)
+        {
+          // Compiled digests are unique, so every slot is marked once
+          int32_t slot = table.Find (*digest);
+          if (slot >= 0)
+            {
+              m_excluded[slot] = 1;
+              m_marked.push_back (slot);
+            }
+        }
+
+      if (m_matcher.HasRanges ())
+        {
+          // Ranges can cover any digest, fall back to checking every version
+          for (uint32_t slot = 0; slot < size; slot++)
+            {
+              if (!m_excluded[slot] && exclude->isExcluded (ExcludeMatcher::MakeComponent (table.digests[slot])))
+                {
+                  m_excluded[slot] = 1;
+                  m_marked.push_back (slot);
+                }
+            }
+        }
+
+      if (!m_disableRanking)
+        {
+          for (std::vector<uint32_t>::const_iterator slot = m_marked.begin (); slot != m_marked.end (); slot++)
+            {
+              if (table.expiration[*slot] > now)
+                RecordExclusion (table, *slot, interest, faceId, now);
+            }
+        }
+    }
+
+  // Every heap node ranks before its children, so the best usable version is the
+  // best of the usable nodes whose ancestors are all excluded or stale
+  int32_t best = -1;
+  m_candidates.clear ();
+  if (!table.heap.empty ())
+    m_candidates.push_back (0);
+  while (!m_candidates.empty ())
+    {
+      uint32_t position = m_candidates.back ();
+      m_candidates.pop_back ();
+      uint32_t slot = table.heap[position];
+
+      if (table.expiration[slot] <= now || m_excluded[slot])
+        {
+          if (2 * position + 1 < size)
+            m_candidates.push_back (2 * position + 1);
+          if (2 * position + 2 < size)
+            m_candidates.push_back (2 * position + 2);
+        }
+      else if (best < 0 || table.Before (slot, best))
+        best = slot;
+    }
+
+  for (std::vector<uint32_t>::const_iterator slot = m_marked.begin (); slot != m_marked.end (); slot++)
+    m_excluded[*slot] = 0;
+
+  return best;
+}
+
+Ptr<const ContentObject>
+RankingTable::GetHeader (VersionTable &table, uint32_t slot)
+{
+  if (!table.headers[slot])
+    {
+      Ptr<ContentObject> header = Create<ContentObject> ();
+      header->SetName (table.name);
+      header->SetFreshness (table.freshness);
+      header->SetTimestamp (table.timestamps[slot]);
+      header->SetSignature (table.signatures[slot]);
+      table.headers[slot] = header;
+    }
+  return table.headers[slot];
+}
+
+void
+RankingTable::RecordExclusion (VersionTable &table, uint32_t slot, Ptr<const Interest> interest, uint32_t faceId,
+                               double now)
+{
+  // A version with exclusions already has its timer, which follows lastExclusion
+  bool pending = table.exclusions[slot] != 0;
+
+  if (IsExclusionDiscarded (table, slot, now))
+    table.ResetExclusions (slot);
+  table.exclusions[slot]++;
+  table.lastExclusion[slot] = now;
+  table.AccountExclusion (slot, faceId);
+
+  if (table.indexed)
+    table.UpdateRank (slot);
+  if (!pending)
+    ScheduleExpiry (table, now + m_exclusionDiscardedTimeout, EXCLUSION_TIMER, table.digests[slot]);
+
+  m_exclusionsTrace (interest, table.digests[slot], faceId);
+}
+
+bool
+RankingTable::IsExclusionDiscarded (const VersionTable &table, uint32_t slot, double now) const
+{
+  return now - table.lastExclusion[slot] >= m_exclusionDiscardedTimeout;
+}
+
+RankingTable::Tables::iterator
+RankingTable::GetTable (const Name &name)
+{
+  Tables::iterator table = m_tables.find (name);
+  if (table == m_tables.end ())
+    {
+      table = m_tables.insert (std::make_pair (name, VersionTable ())).first;
+      table->second.id = m_nextTableId++;
+      table->second.indexed = m_engine == HEAP;
+      table->second.ranked = !m_disableRanking;
+      table->second.sketched = m_accounting == SKETCH;
+      if (table->second.sketched)
+        table->second.sketch = FaceSketch (m_faceSketchRegisters, m_faceSketchWidth);
+      m_tableIds[table->second.id] = table;
+    }
+  return table;
+}
+
+void
+RankingTable::EraseTable (Tables::iterator table)
+{
+  // Pending timers of the table find no owner and are dropped
+  m_tableIds.erase (table->second.id);
+  m_tables.erase (table);
+}
+
+void
+RankingTable::ScheduleExpiry (const VersionTable &table, double deadline, TimerKind kind, uint64_t digest)
+{
+  if (!m_expiryTick.IsStrictlyPositive ())
+    NS_FATAL_ERROR ("ExpiryTick must be positive");
+
+  int64_t step = m_expiryTick.GetTimeStep ();
+  if (m_wheel.GetSize () == 0)
+    {
+      // Idle wheel: catch up with the current time (nothing can expire)
+      m_wheel.Advance (Simulator::Now ().GetTimeStep () / step, m_expiredTimers);
+    }
+
+  TimingWheel::Timer timer;
+  timer.key = digest;
+  timer.owner = table.id;
+  timer.kind = kind;
+  m_wheel.Insert (static_cast<uint64_t> (std::ceil (deadline / m_expiryTick.GetSeconds ())), timer);
+
+  if (!m_tickEvent.IsRunning ())
+    m_tickEvent = Simulator::Schedule (TimeStep ((m_wheel.GetTick () + 1) * step) - Simulator::Now (),
+                                       &RankingTable::Tick, this);
+}
+
+void
+RankingTable::Tick ()
+{
+  int64_t step = m_expiryTick.GetTimeStep ();
+  double now = Simulator::Now ().GetSeconds ();
+
+  m_expiredTimers.clear ();
+  m_wheel.Advance (Simulator::Now ().GetTimeStep () / step, m_expiredTimers);
+  for (std::vector<TimingWheel::Timer>::const_iterator timer = m_expiredTimers.begin ();
+       timer != m_expiredTimers.end (); timer++)
+    Expire (*timer, now);
+
+  // Expire may have scheduled the next tick already
+  if (m_wheel.GetSize () > 0 && !m_tickEvent.IsRunning ())
+    m_tickEvent = Simulator::Schedule (TimeStep ((m_wheel.GetTick () + 1) * step) - Simulator::Now (),
+                                       &RankingTable::Tick, this);
+}
+
+void
+RankingTable::Expire (const TimingWheel::Timer &timer, double now)
+{
+  std::map<uint32_t, Tables::iterator>::iterator owner = m_tableIds.find (timer.owner);
+  if (owner == m_tableIds.end ())
+    return;
+
+  VersionTable &table = owner->second->second;
+  int32_t slot = timer.kind == SWEEP_TIMER ? -1 : table.Find (timer.key);
+  switch (timer.kind)
+    {
+    case EXCLUSION_TIMER:
+      if (slot < 0 || table.exclusions[slot] == 0)
+        break;
+      if (IsExclusionDiscarded (table, slot, now))
+        {
+          table.ResetExclusions (slot);
+          if (table.indexed)
+            table.UpdateRank (slot);
+        }
+      else
+        ScheduleExpiry (table, table.lastExclusion[slot] + m_exclusionDiscardedTimeout, EXCLUSION_TIMER, timer.key);
+      break;
+
+    case FRESHNESS_TIMER:
+      if (slot < 0)
+        break;
+      if (table.expiration[slot] <= now)
+        {
+          table.Remove (slot);
+          m_size--;
+        }
+      else if (table.expiration[slot] != std::numeric_limits<double>::infinity ())
+        ScheduleExpiry (table, table.expiration[slot], FRESHNESS_TIMER, timer.key);
+      break;
+
+    case SWEEP_TIMER:
+      {
+        double next = std::numeric_limits<double>::infinity ();
+        for (uint32_t slot = table.GetSize (); slot-- > 0; )
+          {
+            if (table.expiration[slot] <= now)
+              {
+                table.Remove (slot);
+                m_size--;
+              }
+            else
+              next = std::min (next, table.expiration[slot]);
+          }
+        // Versions refreshed since they were populated
+        if (next != std::numeric_limits<double>::infinity ())
+          ScheduleExpiry (table, next, SWEEP_TIMER, 0);
+        break;
+      }
+    }
+
+  if (table.GetSize () == 0)
+    EraseTable (owner->second);
+}
+
+boost::tuple<Ptr<Packet>, Ptr<const ContentObject>, Ptr<const Packet> >
+RankingTable::Lookup (Ptr<const Interest> interest)
+{
+  bool reported = PeekPointer (interest) == PeekPointer (m_incomingInterest);
+  return Lookup (interest, reported ? m_incomingFace : 0);
+}
+
+void
+RankingTable::NotifyIncomingInterest (Ptr<const Interest> interest, Ptr<const Face> face)
+{
+  m_incomingInterest = interest;
+  m_incomingFace = face->GetId ();
+}
+
+boost::tuple<Ptr<Packet>, Ptr<const ContentObject>, Ptr<const Packet> >
+RankingTable::Lookup (Ptr<const Interest> interest, uint32_t faceId)
+{
+  NS_LOG_FUNCTION (this << interest->GetName ());
+
+  Tables::iterator table = m_tables.find (interest->GetName ());
+  int32_t slot = -1;
+  if (table != m_tables.end ())
+    {
+      if (interest->GetExclude ())
+        m_matcher.Compile (*interest->GetExclude ());
+      else
+        m_matcher.Clear ();
+
+      if (table->second.indexed)
+        slot = SelectIndexed (table->second, interest, faceId);
+      else
+        slot = Select (table->second, interest, faceId);
+    }
+
+  if (slot < 0)
+    {
+      m_cacheMissesTrace (interest);
+      return boost::tuple<Ptr<Packet>, Ptr<const ContentObject>, Ptr<const Packet> > (0, 0, 0);
+    }
+
+  Ptr<const ContentObject> header = GetHeader (table->second, slot);
+  Ptr<const Packet> payload = table->second.payloads[slot];
+
+  static ContentObjectTail tail;
+  Ptr<Packet> packet = payload->Copy ();
+  packet->AddHeader (*header);
+  packet->AddTrailer (tail);
+
+  m_cacheHitsTrace (interest, header);
+  return boost::make_tuple (packet, header, payload);
+}
+
+bool
+RankingTable::Add (Ptr<const ContentObject> header, Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << header->GetName ());
+
+  double now = Simulator::Now ().GetSeconds ();
+  double expiration = std::numeric_limits<double>::infinity ();
+  if (!header->GetFreshness ().IsZero ())
+    expiration = now + header->GetFreshness ().GetSeconds ();
+
+  uint64_t digest = ComputeDigest (*header, *packet);
+  Tables::iterator table = m_tables.find (header->GetName ());
+  if (table != m_tables.end ())
+    {
+      int32_t slot = table->second.Find (digest);
+      if (slot >= 0)
+        {
+          // Same version again, only refresh it.  A pending timer follows the new expiration.
+          if (table->second.expiration[slot] == std::numeric_limits<double>::infinity () &&
+              expiration != std::numeric_limits<double>::infinity ())
+            ScheduleExpiry (table->second, expiration, FRESHNESS_TIMER, digest);
+          table->second.expiration[slot] = expiration;
+          return true;
+        }
+    }
+
+  if (m_maxSize != 0 && m_size >= m_maxSize)
+    EvictOldest ();
+
+  // EvictOldest may have erased the table of this name
+  VersionTable &versions = GetTable (header->GetName ())->second;
+  versions.Append (digest, header, packet, expiration, m_sequence++);
+  m_size++;
+  if (expiration != std::numeric_limits<double>::infinity ())
+    ScheduleExpiry (versions, expiration, FRESHNESS_TIMER, digest);
+  return false;
+}
+
+void
+RankingTable::EvictOldest ()
+{
+  Tables::iterator oldestTable = m_tables.end ();
+  uint32_t oldestSlot = 0;
+  for (Tables::iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      for (uint32_t slot = 0; slot < table->second.GetSize (); slot++)
+        {
+          if (oldestTable == m_tables.end () ||
+              table->second.sequence[slot] < oldestTable->second.sequence[oldestSlot])
+            {
+              oldestTable = table;
+              oldestSlot = slot;
+            }
+        }
+    }
+
+  if (oldestTable == m_tables.end ())
+    return;
+
+  oldestTable->second.Remove (oldestSlot);
+  m_size--;
+  if (oldestTable->second.GetSize () == 0)
+    EraseTable (oldestTable);
+}
+
+void
+RankingTable::Print (std::ostream &os) const
+{
+  double now = Simulator::Now ().GetSeconds ();
+  for (Tables::const_iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      os << table->first << ": " << table->second.GetSize () << " versions" << std::endl;
+      for (uint32_t slot = 0; slot < table->second.GetSize (); slot++)
+        {
+          bool current = !IsExclusionDiscarded (table->second, slot, now);
+          os << "  " << ExcludeMatcher::MakeComponent (table->second.digests[slot])
+             << " exclusions=" << (current ? table->second.exclusions[slot] : 0)
+             << " faces=" << (current ? GetExcludingFaces (table->first, table->second.digests[slot]) : 0)
+             << std::endl;
+        }
+    }
+}
+
+double
+RankingTable::GetExcludingFaces (const Name &name, uint64_t digest) const
+{
+  Tables::const_iterator table = m_tables.find (name);
+  if (table == m_tables.end ())
+    return 0;
+
+  const VersionTable &versions = table->second;
+  int32_t slot = versions.Find (digest);
+  if (slot < 0 || versions.exclusions[slot] == 0 ||
+      IsExclusionDiscarded (versions, slot, Simulator::Now ().GetSeconds ()))
+    return 0;
+
+  return versions.excludingFaces[slot];
+}
+
+uint32_t
+RankingTable::GetExclusions (const Name &name, uint64_t digest) const
+{
+  Tables::const_iterator table = m_tables.find (name);
+  if (table == m_tables.end ())
+    return 0;
+
+  const VersionTable &versions = table->second;
+  int32_t slot = versions.Find (digest);
+  if (slot < 0 || IsExclusionDiscarded (versions, slot, Simulator::Now ().GetSeconds ()))
+    return 0;
+  return versions.exclusions[slot];
+}
+
+uint32_t
+RankingTable::GetFaceExclusions (const Name &name, uint64_t digest, uint32_t faceId) const
+{
+  Tables::const_iterator table = m_tables.find (name);
+  if (table == m_tables.end ())
+    return 0;
+
+  const VersionTable &versions = table->second;
+  int32_t slot = versions.Find (digest);
+  if (slot < 0 || versions.exclusions[slot] == 0 ||
+      IsExclusionDiscarded (versions, slot, Simulator::Now ().GetSeconds ()))
+    return 0;
+
+  if (versions.sketched)
+    return versions.sketch.EstimateExclusions (&versions.faceCounters[static_cast<size_t> (slot) * versions.sketch.GetCounterCount ()],
+                                               faceId);
+
+  std::map<uint64_t, VersionTable::FaceExclusions>::const_iterator faces = versions.faceExclusions.find (digest);
+  if (faces == versions.faceExclusions.end ())
+    return 0;
+  VersionTable::FaceExclusions::const_iterator face =
+    std::lower_bound (faces->second.begin (), faces->second.end (), std::make_pair (faceId, 0u));
+  return face != faces->second.end () && face->first == faceId ? face->second : 0;
+}
+
+uint64_t
+RankingTable::GetAccountingBytes () const
+{
+  // Map nodes are counted with their red-black tree links, not allocator overhead
+  const uint64_t nodeBytes = sizeof (std::pair<const uint64_t, VersionTable::FaceExclusions>) + 4 * sizeof (void *);
+
+  uint64_t bytes = 0;
+  for (Tables::const_iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      const VersionTable &versions = table->second;
+      bytes += versions.faceRegisters.capacity () * sizeof (uint8_t);
+      bytes += versions.faceCounters.capacity () * sizeof (uint32_t);
+      for (std::map<uint64_t, VersionTable::FaceExclusions>::const_iterator faces = versions.faceExclusions.begin ();
+           faces != versions.faceExclusions.end (); faces++)
+        bytes += nodeBytes + faces->second.capacity () * sizeof (VersionTable::FaceExclusions::value_type);
+    }
+  return bytes;
+}
+
+uint32_t
+RankingTable::GetSize () const
+{
+  return m_size;
+}
+
+Ptr<cs::Entry>
+RankingTable::Begin ()
+{
+  return 0;
+}
+
+Ptr<cs::Entry>
+RankingTable::End ()
+{
+  return 0;
+}
+
+Ptr<cs::Entry>
+RankingTable::Next (Ptr<cs::Entry>)
+{
+  return 0;
+}
+
+void
+RankingTable::Populate ()
+{
+  uint32_t bad = static_cast<uint32_t> (std::floor (m_badContentCount * m_badContentRate + 0.5));
+  PopulateVersions (m_badContentCount, bad);
+}
+
+void
+RankingTable::Populate (uint32_t count, uint32_t good)
+{
+  PopulateVersions (count, good < count ? count - good : 0);
+}
+
+void
+RankingTable::PopulateVersions (uint32_t count, uint32_t bad)
+{
+  if (m_badContentNames.empty ())
+    {
+      PopulateVersions (Create<Name> (m_badContentName), count, bad);
+      return;
+    }
+
+  std::istringstream names (m_badContentNames);
+  std::string item;
+  while (std::getline (names, item, ','))
+    {
+      size_t range = item.find ("..");
+      if (range == std::string::npos)
+        {
+          PopulateVersions (Create<Name> (item), count, bad);
+          continue;
+        }
+
+      // Ranges are expanded one name at a time, catalogs may be large
+      size_t slash = item.rfind ('/', range);
+      std::istringstream first_str (item.substr (slash + 1, range - slash - 1));
+      std::istringstream last_str (item.substr (range + 2));
+      uint32_t first = 0;
+      uint32_t last = 0;
+      if (slash == std::string::npos || !(first_str >> first) || !first_str.eof () ||
+          !(last_str >> last) || !last_str.eof () || first > last)
+        NS_FATAL_ERROR ("Invalid range [" << item << "] in BadContentNames");
+
+      std::string prefix = slash == 0 ? "/" : item.substr (0, slash);
+      for (uint32_t seq = first; ; seq++)
+        {
+          Ptr<Name> name = Create<Name> (prefix);
+          (*name) (seq);
+          PopulateVersions (name, count, bad);
+          if (seq == last)
+            break;
+        }
+    }
+}
+
+void
+RankingTable::PopulateVersions (Ptr<Name> name, uint32_t count, uint32_t bad)
+{
+  Ptr<const Packet> payload = GetSharedPayload (m_badContentPayloadSize);
+  Time freshness = Seconds (m_badContentFreshness);
+
+  if (m_maxSize != 0 && m_size + count > m_maxSize)
+    {
+      // Evictions may remove the table being filled, add versions one by one
+      for (uint32_t i = 0; i < count; i++)
+        {
+          Ptr<ContentObject> header = Create<ContentObject> ();
+          header->SetName (name);
+          header->SetFreshness (freshness);
+          header->SetTimestamp (Simulator::Now () + NanoSeconds (i));
+          header->SetSignature (i < count - bad ? 0 : 1);
+
+          Add (header, payload);
+        }
+      return;
+    }
+
+  double expiration = std::numeric_limits<double>::infinity ();
+  if (!freshness.IsZero ())
+    expiration = Simulator::Now ().GetSeconds () + freshness.GetSeconds ();
+
+  VersionTable &table = GetTable (*name)->second;
+  table.name = name;
+  table.freshness = freshness;
+  table.Reserve (table.GetSize () + count);
+
+  // Only the digest needs the encoded header, one scratch header serves all versions
+  Ptr<ContentObject> scratch = Create<ContentObject> ();
+  scratch->SetName (name);
+  scratch->SetFreshness (freshness);
+
+  // Good versions first: on equal rank the most recently added (bad) ones are served
+  for (uint32_t i = 0; i < count; i++)
+    {
+      // Distinct timestamps give every version its own digest
+      Time timestamp = Simulator::Now () + NanoSeconds (i);
+      uint32_t signature = i < count - bad ? 0 : 1;
+      scratch->SetTimestamp (timestamp);
+      scratch->SetSignature (signature);
+
+      uint64_t digest = ComputeDigest (*scratch, *payload);
+      int32_t slot = table.Find (digest);
+      if (slot >= 0)
+        {
+          // Same version again, only refresh it
+          table.expiration[slot] = expiration;
+          continue;
+        }
+
+      table.Append (digest, 0, payload, expiration, m_sequence++, timestamp, signature);
+      m_size++;
+    }
+
+  // All populated versions go stale together, one timer removes them
+  if (count > 0 && expiration != std::numeric_limits<double>::infinity ())
+    ScheduleExpiry (table, expiration, SWEEP_TIMER, 0);
+}
+
+namespace {
+
+const char IMAGE_MAGIC[8] = { 'N', 'D', 'N', 'R', 'T', 'I', 'M', 'G' };
+const uint32_t IMAGE_VERSION = 3;
+
+const uint32_t IMAGE_INDEXED = 1;
+const uint32_t IMAGE_RANKED = 2;
+
+/**
+ * @brief Write data padded to 8 bytes, so that every array of the image stays aligned
+ */
+void
+WriteBytes (std::ostream &os, const void *data, size_t size)
+{
+  static const char zeros[8] = { 0 };
+  os.write (static_cast<const char *> (data), size);
+  os.write (zeros, (8 - size % 8) % 8);
+}
+
+template<class T>
+void
+WriteValue (std::ostream &os, const T &value)
+{
+  WriteBytes (os, &value, sizeof (T));
+}
+
+template<class T>
+void
+WriteArray (std::ostream &os, const std::vector<T> &array)
+{
+  WriteValue (os, static_cast<uint64_t> (array.size ()));
+  if (!array.empty ())
+    WriteBytes (os, &array[0], array.size () * sizeof (T));
+}
+
+/**
+ * @brief Bounds-checked cursor over a mapped image
+ */
+class ImageReader
+{
+public:
+  ImageReader (const uint8_t *data, size_t size)
+    : m_data (data)
+    , m_size (size)
+    , m_offset (0)
+  {
+  }
+
+  /**
+   * @brief Pointer to the next size bytes, 0 if the image is truncated
+   */
+  const uint8_t *
+  Skip (size_t size)
+  {
+    size_t padded = size + (8 - size % 8) % 8;
+    if (padded < size || padded > m_size - m_offset)
+      return 0;
+    const uint8_t *data = m_data + m_offset;
+    m_offset += padded;
+    return data;
+  }
+
+  template<class T>
+  bool
+  ReadValue (T &value)
+  {
+    const uint8_t *data = Skip (sizeof (T));
+    if (data == 0)
+      return false;
+    std::memcpy (&value, data, sizeof (T));
+    return true;
+  }
+
+  template<class T>
+  bool
+  ReadArray (std::vector<T> &array)
+  {
+    uint64_t count;
+    if (!ReadValue (count) || count > (m_size - m_offset) / sizeof (T))
+      return false;
+    // Arrays start at 8-byte aligned offsets of a page-aligned mapping
+    const T *data = reinterpret_cast<const T *> (Skip (count * sizeof (T)));
+    if (data == 0)
+      return false;
+    array.assign (data, data + count);
+    return true;
+  }
+
+private:
+  const uint8_t *m_data;
+  size_t m_size;
+  size_t m_offset;
+};
+
+} // namespace
+
+void
+RankingTable::Save (const std::string &path) const
+{
+  std::ostringstream temporary_str;
+  temporary_str << path << ".tmp." << getpid ();
+  std::string temporary = temporary_str.str ();
+  std::ofstream os (temporary.c_str (), std::ios::binary | std::ios::trunc);
+  if (!os)
+    NS_FATAL_ERROR ("Cannot write content store image [" << temporary << "]");
+
+  os.write (IMAGE_MAGIC, sizeof (IMAGE_MAGIC));
+  WriteValue (os, IMAGE_VERSION);
+  WriteValue (os, static_cast<uint32_t> (m_tables.size ()));
+  WriteValue (os, Simulator::Now ().GetSeconds ());
+  WriteValue (os, m_sequence);
+
+  std::vector<int64_t> timestamps;
+  std::vector<uint32_t> payloadSizes;
+  std::vector<uint8_t> encoded;
+  std::vector<uint64_t> accountedDigests;
+  std::vector<uint32_t> accountedFaceCounts;
+  VersionTable::FaceExclusions accountedFaces;
+  for (Tables::const_iterator table = m_tables.begin (); table != m_tables.end (); table++)
+    {
+      const VersionTable &versions = table->second;
+
+      std::ostringstream name;
+      name << table->first;
+      WriteValue (os, static_cast<uint64_t> (name.str ().size ()));
+      WriteBytes (os, name.str ().data (), name.str ().size ());
+
+      uint32_t flags = (versions.indexed ? IMAGE_INDEXED : 0) | (versions.ranked ? IMAGE_RANKED : 0);
+      WriteValue (os, flags);
+      WriteValue (os, versions.freshness.GetTimeStep ());
+
+      timestamps.clear ();
+      payloadSizes.clear ();
+      for (uint32_t slot = 0; slot < versions.GetSize (); slot++)
+        {
+          timestamps.push_back (versions.timestamps[slot].GetTimeStep ());
+          payloadSizes.push_back (versions.payloads[slot]->GetSize ());
+        }
+
+      WriteArray (os, versions.exclusions);
+      WriteArray (os, versions.lastExclusion);
+      WriteArray (os, versions.expiration);
+      WriteArray (os, versions.sequence);
+      WriteArray (os, versions.digests);
+      WriteArray (os, timestamps);
+      WriteArray (os, versions.signatures);
+      WriteArray (os, payloadSizes);
+      WriteArray (os, versions.index);
+      WriteArray (os, versions.heap);
+      WriteArray (os, versions.heapPosition);
+
+      // Per-face accounting: the sketch geometry and slices, or the exact counts flattened
+      WriteValue (os, versions.sketched ? versions.sketch.GetRegisterCount () : 0);
+      WriteValue (os, versions.sketched ? versions.sketch.GetWidth () : 0);
+      WriteArray (os, versions.faceRegisters);
+      WriteArray (os, versions.faceCounters);
+      accountedDigests.clear ();
+      accountedFaceCounts.clear ();
+      accountedFaces.clear ();
+      for (std::map<uint64_t, VersionTable::FaceExclusions>::const_iterator faces = versions.faceExclusions.begin ();
+           faces != versions.faceExclusions.end (); faces++)
+        {
+          accountedDigests.push_back (faces->first);
+          accountedFaceCounts.push_back (faces->second.size ());
+          accountedFaces.insert (accountedFaces.end (), faces->second.begin (), faces->second.end ());
+        }
+      WriteArray (os, accountedDigests);
+      WriteArray (os, accountedFaceCounts);
+      WriteArray (os, accountedFaces);
+
+      // Versions with a header of their own (added, or populated and served since)
+      uint64_t headers = 0;
+      for (uint32_t slot = 0; slot < versions.GetSize (); slot++)
+        headers += versions.headers[slot] ? 1 : 0;
+      WriteValue (os, headers);
+      for (uint32_t slot = 0; slot < versions.GetSize (); slot++)
+        {
+          if (!versions.headers[slot])
+            continue;
+
+          Ptr<Packet> packet = versions.payloads[slot]->Copy ();
+          packet->AddHeader (*versions.headers[slot]);
+          encoded.resize (packet->GetSize ());
+          if (!encoded.empty ())
+            packet->CopyData (&encoded[0], encoded.size ());
+
+          WriteValue (os, slot);
+          WriteArray (os, encoded);
+        }
+    }
+
+  os.close ();
+  if (!os || rename (temporary.c_str (), path.c_str ()) != 0)
+    NS_FATAL_ERROR ("Cannot write content store image [" << path << "]");
+}
+
+void
+RankingTable::Restore (const std::string &path)
+{
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+    NS_FATAL_ERROR ("Cannot open content store image [" << path << "]: " << strerror (errno));
+
+  struct stat status;
+  if (fstat (fd, &status) != 0 || status.st_size == 0)
+    NS_FATAL_ERROR ("Cannot read content store image [" << path << "]");
+
+  size_t size = status.st_size;
+  void *mapping = mmap (0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (mapping == MAP_FAILED)
+    NS_FATAL_ERROR ("Cannot map content store image [" << path << "]: " << strerror (errno));
+
+  ImageReader image (static_cast<const uint8_t *> (mapping), size);
+  const uint8_t *magic = image.Skip (sizeof (IMAGE_MAGIC));
+  uint32_t version = 0;
+  uint32_t tableCount = 0;
+  double captureTime = 0;
+  uint64_t sequence = 0;
+  if (magic == 0 || std::memcmp (magic, IMAGE_MAGIC, sizeof (IMAGE_MAGIC)) != 0 ||
+      !image.ReadValue (version) || version != IMAGE_VERSION ||
+      !image.ReadValue (tableCount) || !image.ReadValue (captureTime) || !image.ReadValue (sequence))
+    NS_FATAL_ERROR ("[" << path << "] is not a content store image");
+
+  // Drop the current contents, pending timers included
+  m_tickEvent.Cancel ();
+  m_wheel.Clear ();
+  m_tableIds.clear ();
+  m_tables.clear ();
+  m_size = 0;
+  m_sequence = std::max (m_sequence, sequence);
+
+  double now = Simulator::Now ().GetSeconds ();
+  double shift = now - captureTime;
+
+  std::vector<int64_t> timestamps;
+  std::vector<uint32_t> payloadSizes;
+  std::vector<uint8_t> encoded;
+  std::vector<uint64_t> accountedDigests;
+  std::vector<uint32_t> accountedFaceCounts;
+  VersionTable::FaceExclusions accountedFaces;
+  for (uint32_t t = 0; t < tableCount; t++)
+    {
+      uint64_t nameSize = 0;
+      const uint8_t *nameData = 0;
+      uint32_t flags = 0;
+      int64_t freshness = 0;
+      uint32_t registers = 0;
+      uint32_t width = 0;
+      if (!image.ReadValue (nameSize) || nameSize > size ||
+          (nameData = image.Skip (nameSize)) == 0 ||
+          !image.ReadValue (flags) || !image.ReadValue (freshness))
+        NS_FATAL_ERROR ("Truncated content store image [" << path << "]");
+
+      Ptr<Name> name = Create<Name> (std::string (reinterpret_cast<const char *> (nameData), nameSize));
+      VersionTable &versions = GetTable (*name)->second;
+      versions.name = name;
+      versions.freshness = TimeStep (freshness);
+
+      if (!image.ReadArray (versions.exclusions) ||
+          !image.ReadArray (versions.lastExclusion) ||
+          !image.ReadArray (versions.expiration) ||
+          !image.ReadArray (versions.sequence) ||
+          !image.ReadArray (versions.digests) ||
+          !image.ReadArray (timestamps) ||
+          !image.ReadArray (versions.signatures) ||
+          !image.ReadArray (payloadSizes) ||
+          !image.ReadArray (versions.index) ||
+          !image.ReadArray (versions.heap) ||
+          !image.ReadArray (versions.heapPosition) ||
+          !image.ReadValue (registers) ||
+          !image.ReadValue (width) ||
+          !image.ReadArray (versions.faceRegisters) ||
+          !image.ReadArray (versions.faceCounters) ||
+          !image.ReadArray (accountedDigests) ||
+          !image.ReadArray (accountedFaceCounts) ||
+          !image.ReadArray (accountedFaces))
+        NS_FATAL_ERROR ("Truncated content store image [" << path << "]");
+
+      uint32_t count = versions.exclusions.size ();
+      if (versions.lastExclusion.size () != count ||
+          versions.expiration.size () != count || versions.sequence.size () != count ||
+          versions.digests.size () != count || timestamps.size () != count ||
+          versions.signatures.size () != count || payloadSizes.size () != count ||
+          versions.index.size () < 2 * count || (versions.index.size () & (versions.index.size () - 1)) != 0 ||
+          accountedFaceCounts.size () != accountedDigests.size ())
+        NS_FATAL_ERROR ("Corrupted content store image [" << path << "]");
+
+      // Slots of the stored index are not trusted, only its size: rebuilt from the digests
+      versions.Rehash (versions.index.size ());
+
+      // Sketches are kept if their geometry matches, exact counts convert to either mode
+      if (!versions.sketched || registers != versions.sketch.GetRegisterCount () || width != versions.sketch.GetWidth () ||
+          versions.faceRegisters.size () != static_cast<size_t> (count) * registers ||
+          versions.faceCounters.size () != static_cast<size_t> (count) * FaceSketch::DEPTH * width)
+        {
+          versions.faceRegisters.assign (versions.sketched ? static_cast<size_t> (count) * versions.sketch.GetRegisterCount () : 0, 0);
+          versions.faceCounters.assign (versions.sketched ? static_cast<size_t> (count) * versions.sketch.GetCounterCount () : 0, 0);
+        }
+      VersionTable::FaceExclusions::const_iterator face = accountedFaces.begin ();
+      for (uint32_t i = 0; i < accountedDigests.size (); i++)
+        {
+          if (static_cast<size_t> (accountedFaces.end () - face) < accountedFaceCounts[i])
+            NS_FATAL_ERROR ("Corrupted content store image [" << path << "]");
+
+          int32_t slot = versions.Find (accountedDigests[i]);
+          VersionTable::FaceExclusions::const_iterator end = face + accountedFaceCounts[i];
+          if (slot >= 0 && !versions.sketched)
+            versions.faceExclusions[accountedDigests[i]].assign (face, end);
+          for (; slot >= 0 && versions.sketched && face != end; face++)
+            for (uint32_t n = 0; n < face->second; n++)
+              versions.sketch.Add (&versions.faceRegisters[static_cast<size_t> (slot) * versions.sketch.GetRegisterCount ()],
+                                   &versions.faceCounters[static_cast<size_t> (slot) * versions.sketch.GetCounterCount ()],
+                                   face->first);
+          face = end;
+        }
+
+      // Distinct excluding faces are derived from the accounting in the mode of the store
+      versions.excludingFaces.assign (count, 0);
+      for (uint32_t slot = 0; slot < count; slot++)
+        {
+          if (versions.exclusions[slot] == 0)
+            continue;
+          if (versions.sketched)
+            versions.excludingFaces[slot] =
+              versions.sketch.EstimateFaces (&versions.faceRegisters[static_cast<size_t> (slot) * versions.sketch.GetRegisterCount ()]);
+          else
+            {
+              std::map<uint64_t, VersionTable::FaceExclusions>::const_iterator faces = versions.faceExclusions.find (versions.digests[slot]);
+              if (faces != versions.faceExclusions.end ())
+                versions.excludingFaces[slot] = faces->second.size ();
+            }
+        }
+
+      // Pointer fix-up: payloads are shared per size, headers built on demand
+      versions.timestamps.resize (count);
+      versions.payloads.resize (count);
+      versions.headers.assign (count, 0);
+      for (uint32_t slot = 0; slot < count; slot++)
+        {
+          versions.timestamps[slot] = TimeStep (timestamps[slot]);
+          versions.payloads[slot] = GetSharedPayload (payloadSizes[slot]);
+          versions.lastExclusion[slot] += shift;
+          versions.expiration[slot] += shift;
+        }
+
+      uint64_t headers = 0;
+      if (!image.ReadValue (headers) || headers > count)
+        NS_FATAL_ERROR ("Truncated content store image [" << path << "]");
+      for (uint64_t h = 0; h < headers; h++)
+        {
+          uint32_t slot = 0;
+          if (!image.ReadValue (slot) || slot >= count || !image.ReadArray (encoded) || encoded.empty ())
+            NS_FATAL_ERROR ("Truncated content store image [" << path << "]");
+
+          Ptr<Packet> packet = Create<Packet> (&encoded[0], encoded.size ());
+          Ptr<ContentObject> header = Create<ContentObject> ();
+          packet->RemoveHeader (*header);
+          versions.headers[slot] = header;
+          versions.payloads[slot] = packet;
+        }
+
+      // The stored heap is only valid for the same engine and ranking
+      bool ranked = (flags & IMAGE_RANKED) != 0;
+      if (!versions.indexed)
+        {
+          versions.heap.clear ();
+          versions.heapPosition.clear ();
+        }
+      else if (!(flags & IMAGE_INDEXED) || ranked != versions.ranked || !versions.IsHeapValid ())
+        versions.BuildHeap ();
+
+      m_size += count;
+
+      // Timers are not part of the image
+      double nextExpiration = std::numeric_limits<double>::infinity ();
+      for (uint32_t slot = 0; slot < count; slot++)
+        {
+          if (versions.exclusions[slot] != 0)
+            ScheduleExpiry (versions, versions.lastExclusion[slot] + m_exclusionDiscardedTimeout,
+                            EXCLUSION_TIMER, versions.digests[slot]);
+          nextExpiration = std::min (nextExpiration, versions.expiration[slot]);
+        }
+      if (nextExpiration != std::numeric_limits<double>::infinity ())
+        ScheduleExpiry (versions, nextExpiration, SWEEP_TIMER, 0);
+
+      if (count == 0)
+        EraseTable (GetTable (*name));
+    }
+
+  munmap (mapping, size);
+}
+
+} // namespace cs
+} // namespace ndn
+} // namespace ns3
@@ -0,0 +1,512 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef NDN_CS_RANKING_TABLE_H
+#define NDN_CS_RANKING_TABLE_H
+
+#include "ns3/ndn-content-store.h"
+#include "ns3/ndn-content-object.h"
+#include "ns3/ndn-interest.h"
+#include "ns3/ndn-name.h"
+#include "ns3/ndn-face.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/traced-callback.h"
+
+#include "exclude-matcher.h"
+#include "face-sketch.h"
+#include "timing-wheel.h"
+
+#include <boost/tuple/tuple.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+namespace ndn {
+namespace cs {
+
+/**
+ * @brief Content store keeping the ranking state of cached versions in flat per-name arrays
+ *
+ * All versions of a name (e.g., the BadContentCount poisoned versions of
+ * BadContentName) live in one VersionTable.  The state needed to rank them (exclusion
+ * counts, time of the last exclusion, excluding faces, expiration time) is kept in
+ * separate contiguous arrays indexed by version slot, so selecting the best version
+ * is a linear scan over packed values; the content objects themselves are only
+ * touched for the selected slot.
+ *
+ * Versions are told apart by their implicit digest (see GetDigestComponent), which
+ * is also what Interests put in their Exclude filter to reject a version.  The
+ * Exclude filter of every incoming Interest is compiled once into a sorted digest
+ * array (ExcludeMatcher) and matched against the 64-bit digests of the versions.  An
+ * Interest excluding a cached version counts as one exclusion of that version by
+ * the face the Interest came in on.  Exclusions older than ExclusionDiscardedTimeout
+ * are discarded.  Lookup returns the non-excluded, fresh version excluded by the
+ * fewest distinct faces, then with the fewest exclusions (the most recently added one
+ * on ties), or with DisableRanking the most recently added non-excluded version.
+ *
+ * The forwarder only passes the Interest to Lookup.  Its face is taken from
+ * NotifyIncomingInterest, to be connected to the InInterests trace of the node's
+ * forwarding strategy; without it every exclusion comes from face 0, and versions
+ * are ranked by their exclusion count alone.
+ *
+ * The RankingEngine attribute selects how the best version is found:
+ * - scan: every version is re-evaluated on every lookup, O(n) per Interest
+ * - heap: versions are kept in an indexed heap ordered by rank, updated on every
+ *   exclusion and every ExclusionDiscardedTimeout expiry, so that a lookup only
+ *   visits the top of the heap and the versions excluded by the Interest itself
+ *
+ * Expiry of exclusions (ExclusionDiscardedTimeout) and of stale versions (freshness)
+ * is driven by a hierarchical timing wheel advanced by a single periodic event every
+ * ExpiryTick, so the number of scheduled simulator events does not grow with the
+ * cache size.  Exclusions are forgotten and stale versions removed in batches at the
+ * first tick after their deadline; until then stale versions are skipped by lookups.
+ *
+ * The faces that excluded a version are accounted for according to ExclusionAccounting:
+ * - exact: the exclusion count of every excluding face, which grows with the faces
+ * - sketch: a FaceSketch of FaceSketchRegisters distinct-face registers and
+ *   FaceSketchWidth count-min counters per version, a fixed amount of memory
+ *   whatever the number of faces; versions are ranked by the estimated number of
+ *   distinct excluding faces
+ *
+ * Only exact name matches are supported, as in the ranking scenarios where every
+ * Interest asks for the populated name itself.  Excluded components other than
+ * 16-hex-digit digests match nothing, so consumers must exclude with
+ * GetDigestComponent; ConsumerPopulation does, ConsumerCbr of ndnSIM is not known to.
+ */
+class RankingTable : public ContentStore
+{
+public:
+  static TypeId
+  GetTypeId ();
+
+  enum RankingEngine
+    {
+      SCAN,
+      HEAP
+    };
+
+  enum ExclusionAccounting
+    {
+      EXACT,
+      SKETCH
+    };
+
+  RankingTable ();
+  virtual ~RankingTable ();
+
+  /**
+   * @brief Lookup on behalf of Interest, received on the face last reported by NotifyIncomingInterest
+   * for it (face 0 if none)
+   */
+  virtual boost::tuple<Ptr<Packet>, Ptr<const ContentObject>, Ptr<const Packet> >
+  Lookup (Ptr<const Interest> interest);
+
+  /**
+   * @brief Lookup on behalf of Interest received on a face, recording its exclusions
+   */
+  boost::tuple<Ptr<Packet>, Ptr<const ContentObject>, Ptr<const Packet> >
+  Lookup (Ptr<const Interest> interest, uint32_t faceId);
+
+  /**
+   * @brief Record the face interest came in on, for the Lookup (interest) that follows
+   *
+   * Sink of the InInterests trace of ns3::ndn::ForwardingStrategy, which fires before
+   * the strategy looks up the content store.
+   */
+  void
+  NotifyIncomingInterest (Ptr<const Interest> interest, Ptr<const Face> face);
+
+  virtual bool
+  Add (Ptr<const ContentObject> header, Ptr<const Packet> packet);
+
+  virtual void
+  Print (std::ostream &os) const;
+
+  virtual uint32_t
+  GetSize () const;
+
+  /**
+   * @brief Entries are not materialized, iteration over the store is not supported
+   */
+  virtual Ptr<cs::Entry>
+  Begin ();
+
+  virtual Ptr<cs::Entry>
+  End ();
+
+  virtual Ptr<cs::Entry>
+  Next (Ptr<cs::Entry>);
+
+  /**
+   * @brief Add BadContentCount versions of every populated name (BadContentNames, or
+   * BadContentName), a BadContentRate fraction of them bad
+   */
+  virtual void
+  Populate ();
+
+  /**
+   * @brief Add count versions of every populated name, the first good of them good
+   *
+   * Without a MaxSize limit to enforce, versions are added in bulk: every array of
+   * the name's VersionTable grows once, digests are computed on a single scratch
+   * header, and no per-version object is allocated.  Headers of populated versions
+   * are only built when a version is served.  All of it is released at once when the
+   * store is disposed, i.e., at Simulator::Destroy.
+   */
+  virtual void
+  Populate (uint32_t count, uint32_t good);
+
+  /**
+   * @brief Write all versions and their ranking state to an image file
+   *
+   * The image is a host-endian dump of the per-name arrays, digest index and rank
+   * heap.  Populated versions are stored without headers, other versions with their
+   * encoded header and payload.  The image is written to a temporary file and
+   * renamed, so concurrent readers only ever see complete images.
+   */
+  void
+  Save (const std::string &path) const;
+
+  /**
+   * @brief Replace the store contents with an image written by Save
+   *
+   * The image is mmap ()ed and its arrays copied in bulk, only stored headers are
+   * parsed.  Times are shifted so that the capture time of the image becomes now.
+   * Exact per-face exclusions are converted to the ExclusionAccounting of the store;
+   * sketches are kept if their geometry matches, and dropped otherwise.
+   */
+  void
+  Restore (const std::string &path);
+
+  /**
+   * @brief Current exclusions of the version with digest
+   */
+  uint32_t
+  GetExclusions (const Name &name, uint64_t digest) const;
+
+  /**
+   * @brief Number of distinct faces that excluded the version with digest, estimated in sketch mode
+   */
+  double
+  GetExcludingFaces (const Name &name, uint64_t digest) const;
+
+  /**
+   * @brief Exclusions of the version with digest by faceId, an upper bound in sketch mode
+   */
+  uint32_t
+  GetFaceExclusions (const Name &name, uint64_t digest, uint32_t faceId) const;
+
+  /**
+   * @brief Approximate memory used by the per-face exclusion accounting of all versions, in bytes
+   */
+  uint64_t
+  GetAccountingBytes () const;
+
+  /**
+   * @brief Read-only payload of the given size shared by all populated content of the process
+   *
+   * Populated versions differ only in their headers, so they all reference one
+   * payload per size instead of allocating a buffer each.  The payload is never
+   * modified: Lookup returns copies, and ns-3 packets copy their buffer before the
+   * first write to a shared one.
+   */
+  static Ptr<const Packet>
+  GetSharedPayload (uint32_t size);
+
+  /**
+   * @brief Implicit digest of a content version, a 64-bit FNV-1a over the encoded header and payload
+   *
+   * The store computes it once per added object (in Add, i.e., on data arrival and
+   * in Populate) and keeps it with the version; lookups and exclusion checks only
+   * compare the stored digests.  Calls from outside a store (e.g., consumers building
+   * Exclude filters) are not counted by GetDigestComputations.
+   *
+   * The header is encoded into a scratch buffer reused by all calls, and the bytes of
+   * a GetSharedPayload payload are hashed at once from a multiplier cached with it.
+   */
+  static uint64_t
+  GetDigest (const ContentObject &header, const Packet &payload);
+
+  /**
+   * @brief Number of digests computed by stores (in Add and Populate) since the start of the process
+   */
+  static uint64_t
+  GetDigestComputations ();
+
+  /**
+   * @brief Name component identifying a content version in Exclude filters
+   */
+  static name::Component
+  GetDigestComponent (const ContentObject &header, const Packet &payload);
+
+protected:
+  virtual void
+  DoDispose ();
+
+private:
+  /**
+   * @brief All cached versions of one name, in structure-of-arrays layout
+   *
+   * Removing a version moves the last slot into its place, so slots stay dense.
+   * Digests are indexed by an open-addressing hash table in a single array.  A version
+   * with exclusions has exactly one pending exclusion timer.
+   * When indexed, heap holds all slots ordered by rank (fewest excluding faces, then
+   * fewest exclusions, then newest sequence) and heapPosition is its inverse.
+   * Per-face exclusions are kept per digest in exact mode, and in slot-sized slices of
+   * faceRegisters and faceCounters in sketch mode.
+   */
+  struct VersionTable
+  {
+    /**
+     * @brief Exclusion count of every excluding face, ordered by face
+     */
+    typedef std::vector<std::pair<uint32_t, uint32_t> > FaceExclusions;
+
+    VersionTable ();
+
+    uint32_t id;                           ///< @brief owner of the table's expiry timers
+    // Hot: read for every version on every lookup
+    std::vector<uint32_t> exclusions;      ///< @brief exclusions since lastExclusion - ExclusionDiscardedTimeout
+    std::vector<double> lastExclusion;     ///< @brief time of the last exclusion, in seconds
+    std::vector<double> excludingFaces;    ///< @brief distinct excluding faces, estimated in sketch mode
+    std::vector<double> expiration;        ///< @brief end of freshness, in seconds (infinity if none)
+    std::vector<uint64_t> sequence;        ///< @brief insertion order
+    std::vector<uint64_t> digests;         ///< @brief implicit digest (see GetDigest)
+
+    // Cold: only read for the selected version
+    std::vector<Ptr<const ContentObject> > headers; ///< @brief 0 for populated versions not served yet
+    std::vector<Ptr<const Packet> > payloads;
+    std::vector<Time> timestamps;          ///< @brief header timestamp of populated versions
+    std::vector<uint32_t> signatures;      ///< @brief header signature of populated versions
+    Ptr<Name> name;                        ///< @brief header name of populated versions
+    Time freshness;                        ///< @brief header freshness of populated versions
+
+    std::vector<uint32_t> index;           ///< @brief digest hash table of slot + 1 (0 if empty), power of two sized
+
+    // Rank order, only maintained by the heap engine
+    bool indexed;
+    bool ranked;                           ///< @brief false with DisableRanking: order by sequence only
+    std::vector<uint32_t> heap;
+    std::vector<uint32_t> heapPosition;
+
+    // Per-face exclusion accounting
+    bool sketched;
+    FaceSketch sketch;
+    std::map<uint64_t, FaceExclusions> faceExclusions; ///< @brief exact mode, versions with exclusions only
+    std::vector<uint8_t> faceRegisters;    ///< @brief sketch mode, sketch.GetRegisterCount () per slot
+    std::vector<uint32_t> faceCounters;    ///< @brief sketch mode, sketch.GetCounterCount () per slot
+
+    uint32_t
+    GetSize () const;
+
+    /**
+     * @brief Make room for count versions without further allocations
+     */
+    void
+    Reserve (uint32_t count);
+
+    /**
+     * @brief Slot of the version with the given digest, or -1
+     */
+    int32_t
+    Find (uint64_t digest) const;
+
+    /**
+     * @brief Index position of digest, or of the empty position where it belongs
+     */
+    uint32_t
+    Probe (uint64_t digest) const;
+
+    /**
+     * @brief Rebuild the digest index with the given number of positions
+     */
+    void
+    Rehash (uint32_t positions);
+
+    /**
+     * @brief True if the version in slot a ranks before the one in slot b
+     */
+    bool
+    Before (uint32_t a, uint32_t b) const;
+
+    /**
+     * @brief Restore the heap order after the rank of slot changed
+     */
+    void
+    UpdateRank (uint32_t slot);
+
+    void
+    SiftUp (uint32_t position);
+
+    void
+    SiftDown (uint32_t position);
+
+    /**
+     * @brief Order all slots into a new heap
+     */
+    void
+    BuildHeap ();
+
+    /**
+     * @brief Whether heap and heapPosition hold every slot once, in heap order
+     */
+    bool
+    IsHeapValid () const;
+
+    /**
+     * @brief Account one exclusion of slot by faceId, updating excludingFaces
+     */
+    void
+    AccountExclusion (uint32_t slot, uint32_t faceId);
+
+    /**
+     * @brief Forget all exclusions of slot
+     */
+    void
+    ResetExclusions (uint32_t slot);
+
+    void
+    Append (uint64_t digest, Ptr<const ContentObject> header, Ptr<const Packet> payload,
+            double expiration, uint64_t sequence, Time timestamp = Time (), uint32_t signature = 0);
+
+    void
+    Remove (uint32_t slot);
+  };
+
+  typedef std::map<Name, VersionTable> Tables;
+
+  enum TimerKind
+    {
+      EXCLUSION_TIMER, ///< @brief forget the exclusions of the version with the timer's digest
+      FRESHNESS_TIMER, ///< @brief remove the version with the timer's digest once stale
+      SWEEP_TIMER      ///< @brief remove all stale versions of the table (populated versions share one)
+    };
+
+  /**
+   * @brief Table of name, created if needed
+   */
+  Tables::iterator
+  GetTable (const Name &name);
+
+  void
+  EraseTable (Tables::iterator table);
+
+  /**
+   * @brief Add a timer of table firing at the first tick at or after deadline (in seconds)
+   */
+  void
+  ScheduleExpiry (const VersionTable &table, double deadline, TimerKind kind, uint64_t digest);
+
+  /**
+   * @brief Periodic event advancing the timing wheel
+   */
+  void
+  Tick ();
+
+  /**
+   * @brief Apply an expired timer, or schedule it again if its deadline has moved
+   */
+  void
+  Expire (const TimingWheel::Timer &timer, double now);
+
+  /**
+   * @brief Slot of the version to return, or -1 if no version can satisfy the Interest
+   */
+  int32_t
+  Select (VersionTable &table, Ptr<const Interest> interest, uint32_t faceId);
+
+  /**
+   * @brief Select with the heap engine
+   */
+  int32_t
+  SelectIndexed (VersionTable &table, Ptr<const Interest> interest, uint32_t faceId);
+
+  /**
+   * @brief Header of slot, built on first use for populated versions
+   */
+  Ptr<const ContentObject>
+  GetHeader (VersionTable &table, uint32_t slot);
+
+  /**
+   * @brief Count one exclusion of slot by faceId at time now
+   *
+   * Every excluding Interest counts, also one repeated by the same consumer within
+   * ExclusionDiscardedTimeout; the timeout only restarts the count once it elapsed.
+   */
+  void
+  RecordExclusion (VersionTable &table, uint32_t slot, Ptr<const Interest> interest, uint32_t faceId, double now);
+
+  /**
+   * @brief Whether the exclusions of slot are discarded at time now
+   *
+   * The one boundary test used by lookups, getters and timers alike: exclusions are
+   * discarded ExclusionDiscardedTimeout after the last one, inclusive.
+   */
+  bool
+  IsExclusionDiscarded (const VersionTable &table, uint32_t slot, double now) const;
+
+  /**
+   * @brief Evict the oldest version of the whole store
+   */
+  void
+  EvictOldest ();
+
+  /**
+   * @brief Add count versions, bad of them bad, of every populated name
+   */
+  void
+  PopulateVersions (uint32_t count, uint32_t bad);
+
+  void
+  PopulateVersions (Ptr<Name> name, uint32_t count, uint32_t bad);
+
+  /**
+   * @brief GetDigest, counted in GetDigestComputations
+   */
+  static uint64_t
+  ComputeDigest (const ContentObject &header, const Packet &payload);
+
+private:
+  Tables m_tables;
+  uint32_t m_size;
+  uint64_t m_sequence;
+  ExcludeMatcher m_matcher;           ///< @brief Exclude filter of the Interest being looked up
+  std::vector<uint8_t> m_excluded;    ///< @brief scratch space of Select
+  std::vector<uint32_t> m_marked;     ///< @brief scratch space of SelectIndexed, excluded slots
+  std::vector<uint32_t> m_candidates; ///< @brief scratch space of SelectIndexed, heap positions
+  Ptr<const Interest> m_incomingInterest; ///< @brief last Interest reported by NotifyIncomingInterest
+  uint32_t m_incomingFace;            ///< @brief face of m_incomingInterest
+
+  std::map<uint32_t, Tables::iterator> m_tableIds;
+  uint32_t m_nextTableId;
+  TimingWheel m_wheel;
+  std::vector<TimingWheel::Timer> m_expiredTimers; ///< @brief scratch space of Tick
+  EventId m_tickEvent;
+
+  // Attributes
+  uint32_t m_maxSize;
+  double m_exclusionDiscardedTimeout;
+  Time m_expiryTick;
+  bool m_disableRanking;
+  RankingEngine m_engine;
+  ExclusionAccounting m_accounting;
+  uint32_t m_faceSketchRegisters;
+  uint32_t m_faceSketchWidth;
+  std::string m_badContentName;
+  std::string m_badContentNames;
+  double m_badContentFreshness;
+  uint32_t m_badContentPayloadSize;
+  uint32_t m_badContentCount;
+  double m_badContentRate;
+
+  TracedCallback<Ptr<const Interest>, uint64_t, uint32_t> m_exclusionsTrace;
+};
+
+} // namespace cs
+} // namespace ndn
+} // namespace ns3
+
+#endif // NDN_CS_RANKING_TABLE_H
@@ -0,0 +1,279 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "ranking-topology.h"
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/simulator.h"
+#include "ns3/topology-read-module.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("RankingTopology");
+
+namespace ns3 {
+
+static const char CACHE_MAGIC[4] = {'R', 'T', 'O', 'P'};
+static const uint32_t CACHE_VERSION = 1;
+
+RankingTopology::RankingTopology ()
+  : m_offsets (1, 0)
+{
+}
+
+RankingTopology
+RankingTopology::Get (const std::string &name, uint32_t starRouters)
+{
+  if (name == "star")
+    {
+      // Routers are not connected to each other, every router serves its own consumers
+      RankingTopology topology;
+      topology.SetLinks (starRouters, std::vector<Link> ());
+      for (uint32_t i = 0; i < starRouters; i++)
+        topology.m_edgeRouters.push_back (i);
+      return topology;
+    }
+
+  if (name.find ('/') != std::string::npos || name.find ('.') != std::string::npos)
+    return Load (name);
+  else
+    return Load ("topologies/" + name + ".txt");
+}
+
+static bool
+GetModificationTime (const std::string &fileName, time_t &mtime)
+{
+  struct stat info;
+  if (stat (fileName.c_str (), &info) != 0)
+    return false;
+
+  mtime = info.st_mtime;
+  return true;
+}
+
+static uint32_t
+ParseRouter (const std::string &name, const std::string &fileName)
+{
+  char *end = 0;
+  unsigned long router = strtoul (name.c_str (), &end, 10);
+  if (name.empty () || *end != '\0')
+    NS_FATAL_ERROR (fileName << ": router names must be numbers, got [" << name << "]");
+  return static_cast<uint32_t> (router);
+}
+
+RankingTopology
+RankingTopology::Load (const std::string &fileName)
+{
+  std::string routersFileName = fileName.substr (0, fileName.rfind ('.')) + ".routers";
+  std::string cacheFileName = fileName + ".cache";
+
+  time_t linksTime, routersTime = 0, cacheTime;
+  if (!GetModificationTime (fileName, linksTime))
+    NS_FATAL_ERROR ("Cannot open topology file [" << fileName << "]");
+  bool hasRouters = GetModificationTime (routersFileName, routersTime);
+
+  RankingTopology topology;
+  if (GetModificationTime (cacheFileName, cacheTime) &&
+      cacheTime >= linksTime && cacheTime >= routersTime &&
+      topology.LoadCache (cacheFileName))
+    {
+      NS_LOG_DEBUG (fileName << ": loaded from " << cacheFileName);
+      return topology;
+    }
+
+  // Links
+  TopologyReaderHelper reader;
+  reader.SetFileName (fileName);
+  reader.SetFileType ("Orbis");
+  Ptr<TopologyReader> orbis = reader.GetTopologyReader ();
+  if (!orbis)
+    NS_FATAL_ERROR ("Cannot read topology file [" << fileName << "]");
+  orbis->Read ();
+
+  std::vector<Link> links;
+  uint32_t routers = 0;
+  for (TopologyReader::ConstLinksIterator link = orbis->LinksBegin (); link != orbis->LinksEnd (); link++)
+    {
+      uint32_t from = ParseRouter (link->GetFromNodeName (), fileName);
+      uint32_t to = ParseRouter (link->GetToNodeName (), fileName);
+      links.push_back (Link (from, to));
+      routers = std::max (routers, std::max (from, to) + 1);
+    }
+  orbis = 0;
+  // The reader creates a node for every router; drop them, scenarios create their own nodes
+  Simulator::Destroy ();
+
+  // Edge and inner routers
+  if (hasRouters)
+    {
+      std::ifstream file (routersFileName.c_str ());
+      std::string line;
+      while (std::getline (file, line))
+        {
+          std::istringstream is (line);
+          std::string type;
+          if (!(is >> type) || type[0] == '#')
+            continue;
+
+          std::vector<uint32_t> *routerList = 0;
+          if (type == "edge")
+            routerList = &topology.m_edgeRouters;
+          else if (type == "inner")
+            routerList = &topology.m_innerRouters;
+          else
+            NS_FATAL_ERROR (routersFileName << ": unknown router list [" << type << "]");
+
+          std::string router;
+          while (is >> router)
+            {
+              routerList->push_back (ParseRouter (router, routersFileName));
+              routers = std::max (routers, routerList->back () + 1);
+            }
+        }
+    }
+
+  topology.SetLinks (routers, links);
+  NS_LOG_DEBUG (fileName << ": " << routers << " routers, " << links.size () << " links");
+
+  if (!topology.SaveCache (cacheFileName))
+    NS_LOG_WARN ("Cannot write topology cache [" << cacheFileName << "]");
+
+  return topology;
+}
+
+void
+RankingTopology::SetLinks (uint32_t routers, const std::vector<Link> &links)
+{
+  m_offsets.assign (routers + 1, 0);
+  for (std::vector<Link>::const_iterator link = links.begin (); link != links.end (); link++)
+    {
+      m_offsets[link->first + 1]++;
+      m_offsets[link->second + 1]++;
+    }
+  for (uint32_t i = 0; i < routers; i++)
+    m_offsets[i + 1] += m_offsets[i];
+
+  std::vector<uint32_t> fill (m_offsets.begin (), m_offsets.end () - 1);
+  m_adjacency.resize (m_offsets.back ());
+  for (std::vector<Link>::const_iterator link = links.begin (); link != links.end (); link++)
+    {
+      m_adjacency[fill[link->first]++] = link->second;
+      m_adjacency[fill[link->second]++] = link->first;
+    }
+}
+
+static bool
+WriteArray (FILE *file, const std::vector<uint32_t> &array)
+{
+  uint32_t size = array.size ();
+  return fwrite (&size, sizeof (size), 1, file) == 1 &&
+    (size == 0 || fwrite (&array[0], sizeof (uint32_t), size, file) == size);
+}
+
+static bool
+ReadArray (FILE *file, std::vector<uint32_t> &array)
+{
+  uint32_t size;
+  if (fread (&size, sizeof (size), 1, file) != 1)
+    return false;
+
+  array.resize (size);
+  return size == 0 || fread (&array[0], sizeof (uint32_t), size, file) == size;
+}
+
+bool
+RankingTopology::SaveCache (const std::string &fileName) const
+{
+  // Write to a temporary file first, so that concurrent workers never see a partial cache
+  std::ostringstream tmpFileName;
+  tmpFileName << fileName << "." << getpid ();
+
+  FILE *file = fopen (tmpFileName.str ().c_str (), "wb");
+  if (file == 0)
+    return false;
+
+  bool ok = fwrite (CACHE_MAGIC, sizeof (CACHE_MAGIC), 1, file) == 1 &&
+    fwrite (&CACHE_VERSION, sizeof (CACHE_VERSION), 1, file) == 1 &&
+    WriteArray (file, m_offsets) &&
+    WriteArray (file, m_adjacency) &&
+    WriteArray (file, m_edgeRouters) &&
+    WriteArray (file, m_innerRouters);
+  ok = (fclose (file) == 0) && ok;
+
+  if (!ok || rename (tmpFileName.str ().c_str (), fileName.c_str ()) != 0)
+    {
+      remove (tmpFileName.str ().c_str ());
+      return false;
+    }
+  return true;
+}
+
+bool
+RankingTopology::LoadCache (const std::string &fileName)
+{
+  FILE *file = fopen (fileName.c_str (), "rb");
+  if (file == 0)
+    return false;
+
+  char magic[sizeof (CACHE_MAGIC)];
+  uint32_t version = 0;
+  bool ok = fread (magic, sizeof (magic), 1, file) == 1 &&
+    std::equal (magic, magic + sizeof (magic), CACHE_MAGIC) &&
+    fread (&version, sizeof (version), 1, file) == 1 &&
+    version == CACHE_VERSION &&
+    ReadArray (file, m_offsets) &&
+    ReadArray (file, m_adjacency) &&
+    ReadArray (file, m_edgeRouters) &&
+    ReadArray (file, m_innerRouters);
+  fclose (file);
+
+  ok = ok && !m_offsets.empty () && m_offsets.back () == m_adjacency.size ();
+  if (!ok)
+    *this = RankingTopology ();
+  return ok;
+}
+
+uint32_t
+RankingTopology::GetRouterCount () const
+{
+  return m_offsets.size () - 1;
+}
+
+uint32_t
+RankingTopology::GetLinkCount () const
+{
+  return m_adjacency.size () / 2;
+}
+
+const std::vector<uint32_t> &
+RankingTopology::GetOffsets () const
+{
+  return m_offsets;
+}
+
+const std::vector<uint32_t> &
+RankingTopology::GetAdjacency () const
+{
+  return m_adjacency;
+}
+
+const std::vector<uint32_t> &
+RankingTopology::GetEdgeRouters () const
+{
+  return m_edgeRouters;
+}
+
+const std::vector<uint32_t> &
+RankingTopology::GetInnerRouters () const
+{
+  return m_innerRouters;
+}
+
+} // namespace ns3
@@ -0,0 +1,108 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef RANKING_TOPOLOGY_H
+#define RANKING_TOPOLOGY_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * @brief Router-level topology used by the ranking scenarios
+ *
+ * Routers are numbered 0..GetRouterCount ()-1 and adjacency is kept in compressed
+ * sparse row (CSR) form: neighbors of router r are
+ * GetAdjacency ()[GetOffsets ()[r]] .. GetAdjacency ()[GetOffsets ()[r + 1] - 1].
+ *
+ * Consumers are not part of the topology itself, they are attached to the edge
+ * routers (in the order returned by GetEdgeRouters) by the scenario.
+ */
+class RankingTopology
+{
+public:
+  typedef std::pair<uint32_t, uint32_t> Link;
+
+  RankingTopology ();
+
+  /**
+   * @brief Get a topology by name
+   * @param name "star" (isolated routers), name of a file in topologies/ (e.g., "dfn"
+   *             for topologies/dfn.txt), or path to a topology file
+   * @param starRouters number of routers in the "star" topology
+   *
+   * Aborts the program if the topology cannot be loaded
+   */
+  static RankingTopology
+  Get (const std::string &name, uint32_t starRouters = 5);
+
+  /**
+   * @brief Load topology from file, using the binary cache when it is up to date
+   * @param fileName links in Orbis format ("from to" per line), read using the
+   *                 topology-read module.  Edge and inner routers are listed in a
+   *                 file with the same name and ".routers" extension, on lines
+   *                 starting with "edge" and "inner".
+   *
+   * The binary cache is written to fileName + ".cache" and used as long as it is newer
+   * than both text files.
+   */
+  static RankingTopology
+  Load (const std::string &fileName);
+
+  /**
+   * @brief Write the topology as a binary CSR image
+   */
+  bool
+  SaveCache (const std::string &fileName) const;
+
+  /**
+   * @brief Read topology written by SaveCache
+   */
+  bool
+  LoadCache (const std::string &fileName);
+
+  uint32_t
+  GetRouterCount () const;
+
+  uint32_t
+  GetLinkCount () const;
+
+  const std::vector<uint32_t> &
+  GetOffsets () const;
+
+  const std::vector<uint32_t> &
+  GetAdjacency () const;
+
+  /**
+   * @brief Routers consumers are attached to, in the order consumers are attached
+   */
+  const std::vector<uint32_t> &
+  GetEdgeRouters () const;
+
+  /**
+   * @brief Routers that get a populated cache in the "populateIN" scenarios
+   *
+   * Empty if the topology does not define inner routers
+   */
+  const std::vector<uint32_t> &
+  GetInnerRouters () const;
+
+private:
+  /**
+   * @brief Build CSR arrays from a list of undirected links
+   */
+  void
+  SetLinks (uint32_t routers, const std::vector<Link> &links);
+
+private:
+  std::vector<uint32_t> m_offsets;
+  std::vector<uint32_t> m_adjacency;
+  std::vector<uint32_t> m_edgeRouters;
+  std::vector<uint32_t> m_innerRouters;
+};
+
+} // namespace ns3
+
+#endif // RANKING_TOPOLOGY_H
@@ -0,0 +1,146 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "sample-statistics.h"
+
+#include "ns3/fatal-error.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+namespace ns3 {
+
+void
+SampleStatistics::Resize (size_t metrics)
+{
+  if (m_counts.size () >= metrics)
+    return;
+
+  m_counts.resize (metrics, 0);
+  m_sums.resize (metrics, 0);
+  m_sumSquares.resize (metrics, 0);
+}
+
+void
+SampleStatistics::AddSamples (const std::vector<double> &values)
+{
+  Resize (values.size ());
+  for (size_t i = 0; i < values.size (); i++)
+    {
+      m_counts[i]++;
+      m_sums[i] += values[i];
+      m_sumSquares[i] += values[i] * values[i];
+    }
+}
+
+void
+SampleStatistics::Merge (const SampleStatistics &other)
+{
+  Resize (other.m_counts.size ());
+  for (size_t i = 0; i < other.m_counts.size (); i++)
+    {
+      m_counts[i] += other.m_counts[i];
+      m_sums[i] += other.m_sums[i];
+      m_sumSquares[i] += other.m_sumSquares[i];
+    }
+}
+
+uint32_t
+SampleStatistics::GetMetricCount () const
+{
+  return m_counts.size ();
+}
+
+uint64_t
+SampleStatistics::GetSampleCount (uint32_t metric) const
+{
+  return m_counts[metric];
+}
+
+double
+SampleStatistics::GetMean (uint32_t metric) const
+{
+  if (m_counts[metric] == 0)
+    return 0;
+  return m_sums[metric] / m_counts[metric];
+}
+
+double
+SampleStatistics::GetHalfWidth (uint32_t metric, double z) const
+{
+  uint64_t n = m_counts[metric];
+  if (n < 2)
+    return std::numeric_limits<double>::infinity ();
+
+  double mean = m_sums[metric] / n;
+  // Rounding may make the difference slightly negative for (nearly) constant metrics
+  double variance = std::max (0.0, (m_sumSquares[metric] - n * mean * mean) / (n - 1));
+  return z * std::sqrt (variance / n);
+}
+
+double
+SampleStatistics::GetMaxRelativeHalfWidth (double z, double absoluteHalfWidth) const
+{
+  double maxRelative = 0;
+  for (uint32_t i = 0; i < m_counts.size (); i++)
+    {
+      if (m_counts[i] < 2)
+        continue;
+
+      double halfWidth = GetHalfWidth (i, z);
+      double mean = std::fabs (GetMean (i));
+      // Near-zero metrics (e.g., sparse bins) are converged once known in absolute terms
+      if (halfWidth == 0 || halfWidth <= absoluteHalfWidth)
+        continue;
+      if (mean == 0)
+        return std::numeric_limits<double>::infinity ();
+      maxRelative = std::max (maxRelative, halfWidth / mean);
+    }
+  return maxRelative;
+}
+
+double
+SampleStatistics::GetQuantile (double level)
+{
+  if (level <= 0 || level >= 1)
+    NS_FATAL_ERROR ("Confidence level must be between 0 and 1, got " << level);
+
+  // P(|Z| <= z) = erf (z / sqrt (2)) is increasing in z, bisect
+  double low = 0, high = 10;
+  for (int i = 0; i < 64; i++)
+    {
+      double z = (low + high) / 2;
+      if (std::erf (z / std::sqrt (2.0)) < level)
+        low = z;
+      else
+        high = z;
+    }
+  return (low + high) / 2;
+}
+
+void
+SampleStatistics::Serialize (std::ostream &os) const
+{
+  os << m_counts.size () << "\n" << std::setprecision (17);
+  for (size_t i = 0; i < m_counts.size (); i++)
+    os << m_counts[i] << " " << m_sums[i] << " " << m_sumSquares[i] << "\n";
+}
+
+bool
+SampleStatistics::Deserialize (std::istream &is)
+{
+  size_t size = 0;
+  if (!(is >> size))
+    return false;
+
+  m_counts.assign (size, 0);
+  m_sums.assign (size, 0);
+  m_sumSquares.assign (size, 0);
+  for (size_t i = 0; i < size; i++)
+    if (!(is >> m_counts[i] >> m_sums[i] >> m_sumSquares[i]))
+      return false;
+  return true;
+}
+
+} // namespace ns3
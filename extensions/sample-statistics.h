@@ -0,0 +1,87 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef SAMPLE_STATISTICS_H
+#define SAMPLE_STATISTICS_H
+
+#include <stdint.h>
+#include <iostream>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Running mean and confidence interval of a vector of per-iteration metrics
+ *
+ * Only the sample count, sum and sum of squares of every metric are kept, so
+ * statistics of independent sets of iterations (e.g., of worker processes) can be
+ * merged exactly.  Metric i of a sample vector is the i-th reported value of one
+ * iteration; shorter sample vectors leave the remaining metrics without a sample.
+ */
+class SampleStatistics
+{
+public:
+  /**
+   * @brief Add one sample of metrics 0..values.size ()-1
+   */
+  void
+  AddSamples (const std::vector<double> &values);
+
+  /**
+   * @brief Add up statistics of another (independent) set of samples
+   */
+  void
+  Merge (const SampleStatistics &other);
+
+  uint32_t
+  GetMetricCount () const;
+
+  uint64_t
+  GetSampleCount (uint32_t metric) const;
+
+  double
+  GetMean (uint32_t metric) const;
+
+  /**
+   * @brief Half-width of the normal-approximation confidence interval of the mean
+   * @param z standard normal quantile of the confidence level (see GetQuantile)
+   */
+  double
+  GetHalfWidth (uint32_t metric, double z) const;
+
+  /**
+   * @brief Largest half-width relative to the absolute value of the mean
+   * @param absoluteHalfWidth metrics known within this absolute half-width are ignored
+   *
+   * Metrics with fewer than two samples are ignored, metrics that have always been
+   * zero have relative half-width 0.  A metric with mean 0 and a half-width above
+   * absoluteHalfWidth has an infinite relative half-width.  Returns 0 if there are
+   * no such metrics.
+   */
+  double
+  GetMaxRelativeHalfWidth (double z, double absoluteHalfWidth = 0) const;
+
+  /**
+   * @brief Two-sided standard normal quantile for a confidence level (e.g., 1.96 for 0.95)
+   */
+  static double
+  GetQuantile (double level);
+
+  void
+  Serialize (std::ostream &os) const;
+
+  bool
+  Deserialize (std::istream &is);
+
+private:
+  void
+  Resize (size_t metrics);
+
+private:
+  std::vector<uint64_t> m_counts;
+  std::vector<double> m_sums;
+  std::vector<double> m_sumSquares;
+};
+
+} // namespace ns3
+
+#endif // SAMPLE_STATISTICS_H
@@ -0,0 +1,129 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "time-histogram-collector.h"
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+#include "ns3/simulator.h"
+#include "ns3/ndnSIM-module.h"
+
+NS_LOG_COMPONENT_DEFINE ("TimeHistogramCollector");
+
+namespace ns3 {
+
+TimeHistogramCollector::TimeHistogramCollector (Time step, uint32_t bins)
+  : m_step (step)
+  , m_bins (bins)
+  , m_bin (0)
+  , m_registry (0)
+{
+  NS_ASSERT_MSG (m_bins > 0, "Histogram needs at least one bin");
+}
+
+void
+TimeHistogramCollector::Attach (MetricsRegistry *registry)
+{
+  m_registry = registry;
+}
+
+void
+TimeHistogramCollector::Start ()
+{
+  m_bin = 0;
+  m_boundary.Cancel ();
+  if (m_bins > 1)
+    m_boundary = Simulator::Schedule (m_step, &TimeHistogramCollector::Advance, this);
+}
+
+void
+TimeHistogramCollector::Advance ()
+{
+  m_bin++;
+  NS_LOG_DEBUG ("Bin " << m_bin << " starts at " << Simulator::Now ());
+
+  // No boundary after the last bin, later events are counted in it
+  if (m_bin + 1 < m_bins)
+    m_boundary = Simulator::Schedule (m_step, &TimeHistogramCollector::Advance, this);
+}
+
+uint32_t
+TimeHistogramCollector::GetBinCount () const
+{
+  return m_bins;
+}
+
+uint32_t
+TimeHistogramCollector::GetCurrentBin () const
+{
+  return m_bin;
+}
+
+namespace {
+
+/**
+ * @brief Trace sinks recording into the current bin of a histogram
+ */
+class RecordingSink : public SimpleRefCount<RecordingSink>
+{
+public:
+  RecordingSink (TimeHistogramCollector *collector, MetricsRegistry::HistogramId id)
+    : m_collector (collector)
+    , m_id (id)
+  {
+  }
+
+  void
+  ContentReceived (Ptr<const ndn::ContentObject> content)
+  {
+    m_collector->Record (m_id);
+  }
+
+  void
+  ContentObjectsReceived (Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet,
+                          Ptr<ndn::App> app, Ptr<ndn::Face> face)
+  {
+    m_collector->Record (m_id);
+  }
+
+  void
+  ConsumerContentReceived (uint32_t consumer, Ptr<const ndn::ContentObject> content)
+  {
+    m_collector->Record (m_id);
+  }
+
+  void
+  ConsumerContentObjectsReceived (uint32_t consumer, Ptr<const ndn::ContentObject> content, Ptr<const Packet> packet)
+  {
+    m_collector->Record (m_id);
+  }
+
+private:
+  TimeHistogramCollector *m_collector;
+  MetricsRegistry::HistogramId m_id;
+};
+
+} // namespace
+
+void
+TimeHistogramCollector::CountTrace (Ptr<Application> app, const std::string &traceSource, MetricsRegistry::HistogramId id)
+{
+  Ptr<RecordingSink> sink = Create<RecordingSink> (this, id);
+
+  bool connected = false;
+  if (traceSource == "BadContentReceived" || traceSource == "GoodContentReceived")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&RecordingSink::ContentReceived, sink));
+  else if (traceSource == "ReceivedContentObjects")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&RecordingSink::ContentObjectsReceived, sink));
+  else if (traceSource == "ConsumerBadContentReceived" || traceSource == "ConsumerGoodContentReceived")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&RecordingSink::ConsumerContentReceived, sink));
+  else if (traceSource == "ConsumerReceivedContentObjects")
+    connected = app->TraceConnectWithoutContext (traceSource, MakeCallback (&RecordingSink::ConsumerContentObjectsReceived, sink));
+  else
+    NS_FATAL_ERROR ("Counting trace source [" << traceSource << "] is not supported");
+
+  if (!connected)
+    NS_FATAL_ERROR ("Application on node " << app->GetNode ()->GetId ()
+                    << " does not provide trace source [" << traceSource << "]");
+}
+
+} // namespace ns3
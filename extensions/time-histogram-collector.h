@@ -0,0 +1,76 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef TIME_HISTOGRAM_COLLECTOR_H
+#define TIME_HISTOGRAM_COLLECTOR_H
+
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+#include "metrics-registry.h"
+
+namespace ns3 {
+
+/**
+ * @brief Counts trace events into fixed-width simulation time bins
+ *
+ * Bin boundaries are simulator events scheduled by Start, each of them advancing
+ * the current bin.  Recording an event is a single indexed increment of the current
+ * bin of a MetricsRegistry histogram; no time arithmetic is done per packet and
+ * bins without any traffic stay empty instead of being merged with the next one.
+ *
+ * Events after the last boundary are counted in the last bin.
+ */
+class TimeHistogramCollector
+{
+public:
+  TimeHistogramCollector (Time step, uint32_t bins);
+
+  /**
+   * @brief Record into histograms of registry (registered with GetBinCount () bins)
+   */
+  void
+  Attach (MetricsRegistry *registry);
+
+  /**
+   * @brief Start the first bin now and schedule the boundaries of the following ones
+   *
+   * Must be called for every simulation run, before Simulator::Run
+   */
+  void
+  Start ();
+
+  inline void
+  Record (MetricsRegistry::HistogramId id)
+  {
+    m_registry->AddToBin (id, m_bin, 1);
+  }
+
+  uint32_t
+  GetBinCount () const;
+
+  uint32_t
+  GetCurrentBin () const;
+
+  /**
+   * @brief Record every invocation of a consumer trace source in histogram id
+   * @param traceSource BadContentReceived, GoodContentReceived or ReceivedContentObjects, or
+   *                    their Consumer* counterparts of a ConsumerPopulation
+   */
+  void
+  CountTrace (Ptr<Application> app, const std::string &traceSource, MetricsRegistry::HistogramId id);
+
+private:
+  void
+  Advance ();
+
+private:
+  Time m_step;
+  uint32_t m_bins;
+  uint32_t m_bin;
+  MetricsRegistry *m_registry;
+  EventId m_boundary;
+};
+
+} // namespace ns3
+
+#endif // TIME_HISTOGRAM_COLLECTOR_H
@@ -0,0 +1,112 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "timing-wheel.h"
+
+namespace ns3 {
+
+TimingWheel::TimingWheel ()
+  : m_tick (0)
+  , m_size (0)
+{
+}
+
+void
+TimingWheel::Insert (uint64_t tick, const Timer &timer)
+{
+  // The slot of the current tick has been processed already
+  Entry entry;
+  entry.tick = tick > m_tick ? tick : m_tick + 1;
+  entry.timer = timer;
+  Place (entry);
+  m_size++;
+}
+
+void
+TimingWheel::Place (const Entry &entry)
+{
+  uint64_t distance = entry.tick - m_tick;
+  for (uint32_t level = 0; level < LEVELS; level++)
+    {
+      if (distance < (static_cast<uint64_t> (1) << (SLOT_BITS * (level + 1))))
+        {
+          m_slots[level][(entry.tick >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back (entry);
+          return;
+        }
+    }
+  m_overflow.push_back (entry);
+}
+
+void
+TimingWheel::Cascade (std::vector<Entry> &slot)
+{
+  if (slot.empty ())
+    return;
+
+  // Entries may land in the very slot being emptied
+  m_cascading.swap (slot);
+  for (std::vector<Entry>::const_iterator entry = m_cascading.begin (); entry != m_cascading.end (); entry++)
+    Place (*entry);
+  m_cascading.clear ();
+}
+
+void
+TimingWheel::Advance (uint64_t tick, std::vector<Timer> &expired)
+{
+  if (m_size == 0)
+    {
+      if (tick > m_tick)
+        m_tick = tick;
+      return;
+    }
+
+  while (m_tick < tick)
+    {
+      m_tick++;
+
+      // Higher levels come up when all levels below wrap around
+      for (uint32_t level = 1; level < LEVELS; level++)
+        {
+          if ((m_tick & ((static_cast<uint64_t> (1) << (SLOT_BITS * level)) - 1)) != 0)
+            break;
+          Cascade (m_slots[level][(m_tick >> (SLOT_BITS * level)) & (SLOTS - 1)]);
+          if (level == LEVELS - 1)
+            Cascade (m_overflow);
+        }
+
+      std::vector<Entry> &slot = m_slots[0][m_tick & (SLOTS - 1)];
+      for (std::vector<Entry>::const_iterator entry = slot.begin (); entry != slot.end (); entry++)
+        expired.push_back (entry->timer);
+      m_size -= slot.size ();
+      slot.clear ();
+
+      if (m_size == 0)
+        {
+          m_tick = tick;
+          break;
+        }
+    }
+}
+
+uint64_t
+TimingWheel::GetTick () const
+{
+  return m_tick;
+}
+
+uint32_t
+TimingWheel::GetSize () const
+{
+  return m_size;
+}
+
+void
+TimingWheel::Clear ()
+{
+  for (uint32_t level = 0; level < LEVELS; level++)
+    for (uint32_t slot = 0; slot < SLOTS; slot++)
+      m_slots[level][slot].clear ();
+  m_overflow.clear ();
+  m_size = 0;
+}
+
+} // namespace ns3
@@ -0,0 +1,103 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * @brief Hierarchical timing wheel of timers with integer tick deadlines
+ *
+ * Four levels of 64 slots cover 64^4 ticks ahead; later timers wait in an overflow
+ * list.  A timer is placed in the lowest level whose span covers its distance to the
+ * current tick and moves down a level each time the slot it is in comes up, so
+ * inserting is O(1) and advancing by one tick only touches the timers that cascade
+ * or expire.  Slots keep their storage, so a steady number of timers does not
+ * allocate.
+ *
+ * The wheel knows nothing about simulation time: its owner maps ticks to time and
+ * calls Advance from a single periodic event.
+ */
+class TimingWheel
+{
+public:
+  /**
+   * @brief Opaque timer payload, interpreted by the owner of the wheel
+   */
+  struct Timer
+  {
+    uint64_t key;
+    uint32_t owner;
+    uint32_t kind;
+  };
+
+  TimingWheel ();
+
+  /**
+   * @brief Add a timer expiring at the given tick
+   *
+   * Timers for the current or past ticks expire on the next Advance.
+   */
+  void
+  Insert (uint64_t tick, const Timer &timer);
+
+  /**
+   * @brief Move to the given tick, appending all timers expiring up to it to expired
+   *
+   * An empty wheel jumps straight to tick.
+   */
+  void
+  Advance (uint64_t tick, std::vector<Timer> &expired);
+
+  uint64_t
+  GetTick () const;
+
+  /**
+   * @brief Number of pending timers
+   */
+  uint32_t
+  GetSize () const;
+
+  /**
+   * @brief Drop all pending timers
+   */
+  void
+  Clear ();
+
+private:
+  static const uint32_t LEVELS = 4;
+  static const uint32_t SLOT_BITS = 6;
+  static const uint32_t SLOTS = 1 << SLOT_BITS;
+
+  struct Entry
+  {
+    uint64_t tick;
+    Timer timer;
+  };
+
+  /**
+   * @brief Put entry in the level covering its distance to the current tick
+   */
+  void
+  Place (const Entry &entry);
+
+  /**
+   * @brief Re-place the entries of a slot that came up
+   */
+  void
+  Cascade (std::vector<Entry> &slot);
+
+private:
+  std::vector<Entry> m_slots[LEVELS][SLOTS];
+  std::vector<Entry> m_overflow;
+  std::vector<Entry> m_cascading; ///< @brief scratch space of Cascade
+  uint64_t m_tick;
+  uint32_t m_size;
+};
+
+} // namespace ns3
+
+#endif // TIMING_WHEEL_H
@@ -0,0 +1,91 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil -*- */
+
+#include "zipf-sampler.h"
+
+#include "ns3/log.h"
+#include "ns3/fatal-error.h"
+
+#include <cmath>
+#include <map>
+
+NS_LOG_COMPONENT_DEFINE ("ZipfSampler");
+
+namespace ns3 {
+
+ZipfSampler::ZipfSampler (uint32_t n, double exponent)
+  : m_exponent (exponent)
+  , m_normalization (0)
+{
+  if (n == 0)
+    NS_FATAL_ERROR ("Zipf catalog needs at least one name");
+  if (exponent < 0)
+    NS_FATAL_ERROR ("Zipf exponent must not be negative");
+
+  // Scaled probabilities n * P(r), built in place in the thresholds
+  std::vector<double> scaled (n);
+  for (uint32_t r = 0; r < n; r++)
+    {
+      scaled[r] = std::pow (r + 1.0, -exponent);
+      m_normalization += scaled[r];
+    }
+  for (uint32_t r = 0; r < n; r++)
+    scaled[r] *= n / m_normalization;
+
+  std::vector<uint32_t> small;
+  std::vector<uint32_t> large;
+  for (uint32_t r = 0; r < n; r++)
+    (scaled[r] < 1.0 ? small : large).push_back (r);
+
+  m_threshold.assign (n, 1.0f);
+  m_alias.resize (n);
+  for (uint32_t r = 0; r < n; r++)
+    m_alias[r] = r;
+
+  // Each underfull bucket is topped up by one overfull rank
+  while (!small.empty () && !large.empty ())
+    {
+      uint32_t less = small.back ();
+      small.pop_back ();
+      uint32_t more = large.back ();
+
+      m_threshold[less] = static_cast<float> (scaled[less]);
+      m_alias[less] = more;
+
+      scaled[more] -= 1.0 - scaled[less];
+      if (scaled[more] < 1.0)
+        {
+          large.pop_back ();
+          small.push_back (more);
+        }
+    }
+  // Buckets left in either list are full up to rounding errors, their threshold stays 1
+
+  NS_LOG_DEBUG ("Alias table of " << n << " ranks, exponent " << exponent);
+}
+
+Ptr<const ZipfSampler>
+ZipfSampler::Get (uint32_t n, double exponent)
+{
+  // Never destroyed, as the payloads shared by RankingTable
+  static std::map<std::pair<uint32_t, double>, Ptr<const ZipfSampler> > *samplers =
+    new std::map<std::pair<uint32_t, double>, Ptr<const ZipfSampler> > ();
+
+  Ptr<const ZipfSampler> &sampler = (*samplers)[std::make_pair (n, exponent)];
+  if (!sampler)
+    sampler = Create<ZipfSampler> (n, exponent);
+  return sampler;
+}
+
+uint32_t
+ZipfSampler::GetN () const
+{
+  return m_threshold.size ();
+}
+
+double
+ZipfSampler::GetProbability (uint32_t rank) const
+{
+  return std::pow (rank + 1.0, -m_exponent) / m_normalization;
+}
+
+} // namespace ns3
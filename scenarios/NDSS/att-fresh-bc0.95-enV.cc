@@ -38,10 +38,16 @@ main (int argc, char *argv[])
   std::cout << "------------------------------------------------" << std::endl;
   std::cout << "Enable Ranking Rate        Bad Content Reception" << std::endl;
   std::cout << "------------------------------------------------" << std::endl;
+  uint64_t run = RngSeedManager::GetRun ();
   for (int i = 0; i < (1 / DISABLE_RANKING_STEP) + 1; i++)
     {
       float disable_ranking = 0 + (DISABLE_RANKING_STEP * i);
 
+      // Every step draws from its own run, reproducible with --RngSeed and --RngRun
+      RngSeedManager::SetRun (run + i);
+      Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+      random->SetStream (0);
+
       // Creating nodes
       NodeContainer nodes;
       nodes.Create (NUM_OF_CONSUMERS + NUM_OF_ROUTERS);
@@ -141,9 +147,8 @@ main (int argc, char *argv[])
       // 41 done
       
       // Install CCNx with cache on all routers
-      srand(time(0));
       std::ostringstream exclusion_discard_timeout;
-      exclusion_discard_timeout << (rand() % 400) + 100;
+      exclusion_discard_timeout << random->GetInteger (100, 499);
       std::ostringstream bad_content_count;
       bad_content_count << BAD_CONTENT_COUNT;
       std::ostringstream bad_content_rate;
@@ -151,7 +156,7 @@ main (int argc, char *argv[])
 
       ndn::StackHelper ccnxHelperWithCache;
       ccnxHelperWithCache.SetDefaultRoutes (true);
-      int r = rand() / RAND_MAX;
+      double r = random->GetValue ();
       if (disable_ranking != 0 & r <= disable_ranking)
 	{
 	  ccnxHelperWithCache.SetContentStore ("ns3::ndn::cs::Freshness::Lru", "MaxSize", "0", "ExclusionDiscardedTimeout", exclusion_discard_timeout.str(), "DisableRanking", "false");
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+#include "ns3/map-scheduler.h"
+
+#include "ranking-scenario.h"
+
+using namespace ns3;
+
+// Cost of consumer Interest scheduling in the ranking scenario.  For every number of
+// consumers per edge router in --populations, one iteration of the scenario (the
+// att stop scenario by default) is run with every consumer layout in --modes:
+//
+//   nodes:     a node and ConsumerCbr per consumer
+//   events:    a ConsumerPopulation per edge router, one simulator event per Interest
+//   calendar:  a ConsumerPopulation per edge router, one event per --calendarTick
+//
+// and reports the insertions into the simulator's scheduler (in total and per
+// simulated second), setup and run wall time, and the earliest stopping time.  All
+// ranking scenario parameters are accepted, e.g.
+//
+//   ./build/consumer-scheduling-benchmark --populations=16,160,1600 --calendarTick=1ms
+
+static uint64_t g_insertions = 0;
+
+namespace ns3 {
+
+/**
+ * @brief Map scheduler counting the events inserted into it
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId
+  GetTypeId ()
+  {
+    static TypeId tid = TypeId ("ns3::CountingScheduler")
+      .SetParent<MapScheduler> ()
+      .AddConstructor<CountingScheduler> ()
+      ;
+    return tid;
+  }
+
+  virtual void
+  Insert (const Scheduler::Event &ev)
+  {
+    g_insertions++;
+    MapScheduler::Insert (ev);
+  }
+};
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+} // namespace ns3
+
+static std::vector<std::string>
+ParseList (const std::string &list)
+{
+  std::vector<std::string> values;
+  std::istringstream is (list);
+  std::string value;
+  while (std::getline (is, value, ','))
+    values.push_back (value);
+  return values;
+}
+
+int
+main (int argc, char *argv[])
+{
+  Config::SetDefault ("ns3::PointToPointNetDevice::DataRate", StringValue ("1Mbps"));
+  Config::SetDefault ("ns3::PointToPointChannel::Delay", StringValue ("10ms"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("20"));
+
+  // att-fresh-populate-stop-bc1.99-bCr0.05-WR
+  RankingParameters params;
+  params.topology = "att";
+  params.badConsumerRate = 0.05;
+  params.goodContentTimeout = 400;
+  params.populatedContentCount = 100;
+  params.goodContentCount = 1;
+  params.frequency = "5";
+  params.randomize = "uniform";
+  params.output = "stop";
+  params.iterations = 1;
+
+  std::string populations = "10,100,1000";
+  std::string modes = "nodes,events,calendar";
+
+  CommandLine cmd;
+  params.AddCommandLineArguments (cmd);
+  cmd.AddValue ("populations", "Comma-separated numbers of consumers per edge router", populations);
+  cmd.AddValue ("modes", "Comma-separated consumer layouts: nodes, events or calendar", modes);
+  cmd.Parse (argc, argv);
+
+  // Every simulator created after Simulator::Destroy uses it
+  GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CountingScheduler"));
+
+  RankingTopology topology = RankingTopology::Get (params.topology, params.starRouters);
+
+  std::cout << "---------------------------------------------------------------------------------------------" << std::endl;
+  std::cout << " Consumers      Mode     Insertions   Insertions/sim s   Setup (s)     Run (s)    Stop (us)" << std::endl;
+  std::cout << "---------------------------------------------------------------------------------------------" << std::endl;
+
+  std::vector<std::string> populationList = ParseList (populations);
+  std::vector<std::string> modeList = ParseList (modes);
+  for (size_t i = 0; i < populationList.size (); i++)
+    {
+      for (size_t j = 0; j < modeList.size (); j++)
+	{
+	  const std::string &mode = modeList[j];
+	  if (mode != "nodes" && mode != "events" && mode != "calendar")
+	    NS_FATAL_ERROR ("Unknown mode [" << mode << "], expected nodes, events or calendar");
+
+	  RankingParameters point = params;
+	  point.consumersPerEdge = atoi (populationList[i].c_str ());
+	  point.consumerPopulation = mode != "nodes";
+	  point.consumerScheduling = mode == "calendar" ? "calendar" : "events";
+
+	  RankingScenario scenario (point, topology);
+	  RankingResults results (point);
+	  g_insertions = 0;
+	  scenario.Run (results);
+
+	  double simulatedSeconds = results.iterations * point.totalDuration - results.skippedSeconds;
+
+	  std::cout << std::fixed << std::setprecision (2);
+	  std::cout << std::setw (10) << scenario.GetConsumerCount ();
+	  std::cout << std::setw (10) << mode;
+	  std::cout << std::setw (15) << g_insertions;
+	  std::cout << std::setw (19) << (simulatedSeconds > 0 ? g_insertions / simulatedSeconds : 0);
+	  std::cout << std::setw (12) << results.setupSeconds;
+	  std::cout << std::setw (12) << results.runSeconds;
+	  std::cout << std::setw (13) << results.stoppingMicroSeconds / results.iterations;
+	  std::cout << std::endl;
+	}
+    }
+  std::cout << "---------------------------------------------------------------------------------------------" << std::endl;
+
+  return 0;
+}
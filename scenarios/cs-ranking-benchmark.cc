@@ -0,0 +1,179 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "benchmark-stats.h"
+#include "ranking-table.h"
+#include "exclude-matcher.h"
+
+using namespace ns3;
+
+// Microbenchmark of content store lookups (ns3::ndn::cs::Freshness::Lru by default,
+// or --contentStore) with ranking enabled and disabled.  For every store size, the store is filled with
+// Populate (size, goodContentCount) and the same Interests for the populated name
+// are replayed, once without and once with an Exclude filter of --excludes
+// components.  Reports ns/lookup, heap allocations/lookup and p50/p99 latency, and on
+// stderr the implicit digests computed by ns3::ndn::cs::RankingTable, e.g.
+//
+//   ./build/cs-ranking-benchmark --sizes=10,1000,100000 --lookups=100000
+//   ./build/cs-ranking-benchmark --contentStore=ns3::ndn::cs::RankingTable
+
+static uint64_t g_allocations = 0;
+
+void *
+operator new (size_t size)
+{
+  g_allocations++;
+  void *memory = malloc (size == 0 ? 1 : size);
+  if (memory == 0)
+    throw std::bad_alloc ();
+  return memory;
+}
+
+void
+operator delete (void *memory) throw ()
+{
+  free (memory);
+}
+
+static Ptr<ndn::ContentStore>
+CreateStore (const std::string &contentStore, uint32_t size, uint32_t goodContentCount, bool disableRanking, uint32_t payloadSize)
+{
+  std::ostringstream payload_size;
+  payload_size << payloadSize;
+
+  ObjectFactory factory;
+  factory.SetTypeId (contentStore);
+  factory.Set ("MaxSize", StringValue ("0"));
+  factory.Set ("DisableRanking", BooleanValue (disableRanking));
+  factory.Set ("BadContentName", StringValue ("/prefix/0"));
+  factory.Set ("BadContentFreshness", StringValue ("36000"));
+  factory.Set ("BadContentPayloadSize", StringValue (payload_size.str ()));
+
+  Ptr<ndn::ContentStore> store = factory.Create<ndn::ContentStore> ();
+  store->Populate (size, goodContentCount);
+  return store;
+}
+
+static std::vector<Ptr<ndn::Interest> >
+CreateInterests (uint32_t count, uint32_t excludes)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (0);
+
+  std::vector<Ptr<ndn::Interest> > interests;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<ndn::Interest> interest = Create<ndn::Interest> ();
+      interest->SetName (Create<ndn::Name> ("/prefix/0"));
+      interest->SetNonce (random->GetInteger (0, 0x7fffffff));
+
+      if (excludes > 0)
+	{
+	  // Digest components (16 hex digits, as the store parses them) that match none
+	  // of the populated objects
+	  Ptr<ndn::Exclude> exclude = Create<ndn::Exclude> ();
+	  for (uint32_t j = 0; j < excludes; j++)
+	    {
+	      uint64_t digest = random->GetInteger (0, 0x7fffffff);
+	      exclude->excludeOne (ndn::ExcludeMatcher::MakeComponent (digest));
+	    }
+	  interest->SetExclude (exclude);
+	}
+      interests.push_back (interest);
+    }
+  return interests;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string contentStore = "ns3::ndn::cs::Freshness::Lru";
+  std::string sizes = "10,100,1000,10000,100000,1000000";
+  uint32_t goodContentCount = 1;
+  uint32_t lookups = 100000;
+  uint32_t excludes = 16;
+  uint32_t payloadSize = 64;
+
+  CommandLine cmd;
+  cmd.AddValue ("contentStore", "Content store policy", contentStore);
+  cmd.AddValue ("sizes", "Comma-separated numbers of populated content objects", sizes);
+  cmd.AddValue ("goodContentCount", "Number of good content objects among populated ones", goodContentCount);
+  cmd.AddValue ("lookups", "Measured lookups per configuration", lookups);
+  cmd.AddValue ("excludes", "Number of excluded components in the Exclude filter", excludes);
+  cmd.AddValue ("payloadSize", "Payload size of populated content", payloadSize);
+  cmd.Parse (argc, argv);
+
+  std::cerr << "Clock overhead: " << BenchmarkStats::GetClockOverhead () << " ns (included in latencies)" << std::endl;
+
+  std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+  std::cout << "      Size   Ranking   Excludes     ns/lookup   allocs/lookup     p50 (ns)     p99 (ns)" << std::endl;
+  std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+
+  std::vector<Ptr<ndn::Interest> > plain = CreateInterests (1024, 0);
+  std::vector<Ptr<ndn::Interest> > excluding = CreateInterests (1024, excludes);
+
+  BenchmarkStats stats;
+  std::istringstream size_list (sizes);
+  std::string size_str;
+  while (std::getline (size_list, size_str, ','))
+    {
+      uint32_t size = atoi (size_str.c_str ());
+      for (int disableRanking = 0; disableRanking <= 1; disableRanking++)
+	{
+	  uint64_t digests = ndn::cs::RankingTable::GetDigestComputations ();
+	  Ptr<ndn::ContentStore> store = CreateStore (contentStore, size, goodContentCount, disableRanking, payloadSize);
+	  uint64_t populateDigests = ndn::cs::RankingTable::GetDigestComputations () - digests;
+	  digests = ndn::cs::RankingTable::GetDigestComputations ();
+
+	  for (int withExclude = 0; withExclude <= 1; withExclude++)
+	    {
+	      const std::vector<Ptr<ndn::Interest> > &interests = withExclude ? excluding : plain;
+
+	      // Warm up caches and lazily built state
+	      for (uint32_t i = 0; i < std::min<uint32_t> (lookups, 1000); i++)
+		store->Lookup (interests[i % interests.size ()]);
+
+	      stats.Reset (lookups);
+	      uint64_t allocations = g_allocations;
+	      uint64_t start = BenchmarkStats::Now ();
+	      for (uint32_t i = 0; i < lookups; i++)
+		{
+		  uint64_t lookupStart = BenchmarkStats::Now ();
+		  store->Lookup (interests[i % interests.size ()]);
+		  stats.Record (BenchmarkStats::Now () - lookupStart);
+		}
+	      uint64_t elapsed = BenchmarkStats::Now () - start;
+	      allocations = g_allocations - allocations;
+
+	      std::cout << std::fixed << std::setprecision (2);
+	      std::cout << std::setw (10) << size;
+	      std::cout << std::setw (10) << (disableRanking ? "off" : "on");
+	      std::cout << std::setw (11) << (withExclude ? excludes : 0);
+	      std::cout << std::setw (14) << (double)elapsed / lookups;
+	      std::cout << std::setw (16) << (double)allocations / lookups;
+	      std::cout << std::setw (13) << stats.GetPercentile (0.5);
+	      std::cout << std::setw (13) << stats.GetPercentile (0.99);
+	      std::cout << std::endl;
+	    }
+
+	  std::cerr << "Size " << size << ", ranking " << (disableRanking ? "off" : "on") << ": "
+		    << populateDigests << " digest computations while populating, "
+		    << ndn::cs::RankingTable::GetDigestComputations () - digests << " during lookups" << std::endl;
+
+	  store = 0;
+	  // Drop expiration events of the populated content
+	  Simulator::Destroy ();
+	}
+    }
+  std::cout << "-----------------------------------------------------------------------------------------" << std::endl;
+
+  return 0;
+}
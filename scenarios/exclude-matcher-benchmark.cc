@@ -0,0 +1,150 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "benchmark-stats.h"
+#include "exclude-matcher.h"
+#include "ranking-table.h"
+
+using namespace ns3;
+
+// Microbenchmark of matching the Exclude filter of one Interest against every cached
+// version of the requested name, as ranking content stores do on every lookup.
+// For every number of cached versions in --versions (POPULATED_CONTENT_COUNT of the
+// 50c5r scenarios) and every Exclude filter size in --excludes, half of the excluded
+// components are digests of cached versions and half match nothing.  Compares
+//
+//   components: Exclude::isExcluded on the digest component of every version
+//   compiled:   ExcludeMatcher::Compile once, then a binary search per version digest
+//
+// and reports the excluded versions per Interest (the same for both matchers) and
+// ns/Interest with p50/p99 latency, e.g.
+//
+//   ./build/exclude-matcher-benchmark --versions=100,2000 --excludes=16,256,2000
+
+static std::vector<uint32_t>
+ParseList (const std::string &list)
+{
+  std::vector<uint32_t> values;
+  std::istringstream is (list);
+  std::string value;
+  while (std::getline (is, value, ','))
+    values.push_back (atoi (value.c_str ()));
+  return values;
+}
+
+static std::vector<uint64_t>
+CreateVersions (uint32_t count)
+{
+  Ptr<ndn::Name> name = Create<ndn::Name> ("/prefix/0");
+
+  std::vector<uint64_t> digests;
+  for (uint32_t i = 0; i < count; i++)
+    {
+      Ptr<ndn::ContentObject> header = Create<ndn::ContentObject> ();
+      header->SetName (name);
+      header->SetTimestamp (NanoSeconds (i));
+      header->SetSignature (1);
+      digests.push_back (ndn::cs::RankingTable::GetDigest (*header, *Create<Packet> (1024)));
+    }
+  return digests;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string versions = "100,2000";
+  std::string excludes = "16,256,2000";
+  uint32_t interests = 10000;
+
+  CommandLine cmd;
+  cmd.AddValue ("versions", "Comma-separated numbers of cached versions", versions);
+  cmd.AddValue ("excludes", "Comma-separated numbers of excluded components per Interest", excludes);
+  cmd.AddValue ("interests", "Measured Interests per configuration", interests);
+  cmd.Parse (argc, argv);
+
+  std::vector<uint32_t> versionCounts = ParseList (versions);
+  std::vector<uint32_t> excludeCounts = ParseList (excludes);
+
+  std::cerr << "Clock overhead: " << BenchmarkStats::GetClockOverhead () << " ns (included in latencies)" << std::endl;
+
+  std::cout << "------------------------------------------------------------------------------------" << std::endl;
+  std::cout << "  Versions   Excludes     Matcher   Excluded   ns/Interest     p50 (ns)     p99 (ns)" << std::endl;
+  std::cout << "------------------------------------------------------------------------------------" << std::endl;
+
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (0);
+
+  BenchmarkStats stats;
+  ndn::ExcludeMatcher matcher;
+  for (std::vector<uint32_t>::const_iterator versionCount = versionCounts.begin (); versionCount != versionCounts.end (); versionCount++)
+    {
+      std::vector<uint64_t> digests = CreateVersions (*versionCount);
+      std::vector<ndn::name::Component> components;
+      for (uint32_t i = 0; i < digests.size (); i++)
+	components.push_back (ndn::ExcludeMatcher::MakeComponent (digests[i]));
+
+      for (std::vector<uint32_t>::const_iterator excludeCount = excludeCounts.begin (); excludeCount != excludeCounts.end (); excludeCount++)
+	{
+	  // A few different filters, so that a single one does not stay in the branch predictor
+	  std::vector<Ptr<ndn::Exclude> > filters;
+	  for (uint32_t f = 0; f < 16; f++)
+	    {
+	      Ptr<ndn::Exclude> exclude = Create<ndn::Exclude> ();
+	      for (uint32_t j = 0; j < *excludeCount; j++)
+		{
+		  uint64_t digest;
+		  if (j % 2 == 0 && !digests.empty ())
+		    digest = digests[random->GetInteger (0, digests.size () - 1)];
+		  else
+		    digest = (static_cast<uint64_t> (random->GetInteger (0, 0x7fffffff)) << 32) | random->GetInteger (0, 0x7fffffff);
+		  exclude->excludeOne (ndn::ExcludeMatcher::MakeComponent (digest));
+		}
+	      filters.push_back (exclude);
+	    }
+
+	  for (int compiled = 0; compiled <= 1; compiled++)
+	    {
+	      uint32_t excluded = 0;
+	      stats.Reset (interests);
+	      uint64_t start = BenchmarkStats::Now ();
+	      for (uint32_t i = 0; i < interests; i++)
+		{
+		  const ndn::Exclude &exclude = *filters[i % filters.size ()];
+		  uint64_t interestStart = BenchmarkStats::Now ();
+		  if (compiled)
+		    {
+		      matcher.Compile (exclude);
+		      for (uint32_t v = 0; v < digests.size (); v++)
+			excluded += matcher.IsExcluded (digests[v]);
+		    }
+		  else
+		    {
+		      for (uint32_t v = 0; v < components.size (); v++)
+			excluded += exclude.isExcluded (components[v]);
+		    }
+		  stats.Record (BenchmarkStats::Now () - interestStart);
+		}
+	      uint64_t elapsed = BenchmarkStats::Now () - start;
+
+	      std::cout << std::fixed << std::setprecision (2);
+	      std::cout << std::setw (10) << *versionCount;
+	      std::cout << std::setw (11) << *excludeCount;
+	      std::cout << std::setw (12) << (compiled ? "compiled" : "components");
+	      std::cout << std::setw (11) << (double)excluded / interests;
+	      std::cout << std::setw (14) << (double)elapsed / interests;
+	      std::cout << std::setw (13) << stats.GetPercentile (0.5);
+	      std::cout << std::setw (13) << stats.GetPercentile (0.99);
+	      std::cout << std::endl;
+	    }
+	}
+    }
+  std::cout << "------------------------------------------------------------------------------------" << std::endl;
+
+  return 0;
+}
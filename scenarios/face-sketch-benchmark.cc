@@ -0,0 +1,246 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <list>
+#include <map>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "face-sketch.h"
+#include "ranking-scenario.h"
+#include "ranking-table.h"
+
+using namespace ns3;
+
+// Accuracy-vs-memory report of the per-face exclusion accounting of
+// ns3::ndn::cs::RankingTable, measured on ranking scenario runs.  For every topology
+// in --topologies and every number of consumers per edge router in --consumersPerEdge,
+// one iteration of the ranking scenario is run with RankingTable caches in exact
+// mode (and a ConsumerPopulation per edge router, which RankingTable requires).
+// Every exclusion recorded by a cache (its Exclusions trace, with the face of the
+// Interest) is also added to a FaceSketch per --sketches geometry (FaceSketchRegisters
+// x FaceSketchWidth) of the excluded version, cleared whenever the cache starts
+// counting the version anew.  After each exclusion the sketch estimates are compared
+// with the exact accounting of the cache:
+//
+//   exclusions:     exclusions recorded by all caches
+//   faces (max):    largest number of distinct faces that excluded one version
+//   bytes/version:  accounting memory per cached version (at its peak for exact)
+//   faces err:      mean and max relative error of the distinct excluding faces
+//   count over:     mean overestimate of the exclusions of the excluding face
+//
+// All ranking scenario parameters are accepted, e.g.
+//
+//   ./build/face-sketch-benchmark --topologies=dfn,att --consumersPerEdge=1,10,100 --output=stop
+
+static std::vector<std::string>
+ParseList (const std::string &list)
+{
+  std::vector<std::string> values;
+  std::istringstream is (list);
+  std::string value;
+  while (std::getline (is, value, ','))
+    values.push_back (value);
+  return values;
+}
+
+struct Accuracy
+{
+  Accuracy () : faceError (0), maxFaceError (0), overestimate (0), samples (0) {}
+
+  double faceError;
+  double maxFaceError;
+  double overestimate;
+  uint64_t samples;
+};
+
+/**
+ * @brief Sketches of the excluded versions of one cache, one per geometry
+ */
+struct Shadow
+{
+  struct Sketches
+  {
+    std::vector<std::vector<uint8_t> > registers;
+    std::vector<std::vector<uint32_t> > counters;
+  };
+
+  Shadow () : size (0), peakBytes (0) {}
+
+  Ptr<ndn::cs::RankingTable> store;
+  uint32_t size;                ///< @brief cached versions once populated
+  uint64_t peakBytes;           ///< @brief largest exact accounting memory
+  std::map<uint64_t, Sketches> versions;
+};
+
+static std::vector<FaceSketch> g_sketches;
+static std::vector<Accuracy> g_accuracy;
+static std::list<Shadow> g_shadows;
+static uint64_t g_exclusions = 0;
+static uint32_t g_maxFaces = 0;
+
+static void
+Exclusion (Shadow *shadow, Ptr<const ndn::Interest> interest, uint64_t digest, uint32_t faceId)
+{
+  const ndn::Name &name = interest->GetName ();
+  Ptr<ndn::cs::RankingTable> store = shadow->store;
+  Shadow::Sketches &sketches = shadow->versions[digest];
+
+  // First exclusion since the cache discarded the previous ones (or ever)
+  if (sketches.registers.empty () || store->GetExclusions (name, digest) == 1)
+    {
+      sketches.registers.resize (g_sketches.size ());
+      sketches.counters.resize (g_sketches.size ());
+      for (uint32_t g = 0; g < g_sketches.size (); g++)
+	{
+	  sketches.registers[g].assign (g_sketches[g].GetRegisterCount (), 0);
+	  sketches.counters[g].assign (g_sketches[g].GetCounterCount (), 0);
+	}
+    }
+
+  double faces = store->GetExcludingFaces (name, digest);
+  uint32_t exclusions = store->GetFaceExclusions (name, digest, faceId);
+  g_exclusions++;
+  g_maxFaces = std::max (g_maxFaces, static_cast<uint32_t> (faces));
+  shadow->peakBytes = std::max (shadow->peakBytes, store->GetAccountingBytes ());
+
+  for (uint32_t g = 0; g < g_sketches.size (); g++)
+    {
+      g_sketches[g].Add (&sketches.registers[g][0], &sketches.counters[g][0], faceId);
+
+      double error = std::fabs (g_sketches[g].EstimateFaces (&sketches.registers[g][0]) - faces) / faces;
+      g_accuracy[g].faceError += error;
+      g_accuracy[g].maxFaceError = std::max (g_accuracy[g].maxFaceError, error);
+      g_accuracy[g].overestimate +=
+	static_cast<double> (g_sketches[g].EstimateExclusions (&sketches.counters[g][0], faceId)) - exclusions;
+      g_accuracy[g].samples++;
+    }
+}
+
+static void
+ConnectCaches (const NodeContainer &nodes)
+{
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<ndn::cs::RankingTable> store = DynamicCast<ndn::cs::RankingTable> (nodes.Get (i)->GetObject<ndn::ContentStore> ());
+      if (!store)
+	continue;
+
+      g_shadows.push_back (Shadow ());
+      Shadow &shadow = g_shadows.back ();
+      shadow.store = store;
+      shadow.size = store->GetSize ();
+      store->TraceConnectWithoutContext ("Exclusions", MakeBoundCallback (&Exclusion, &shadow));
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  Config::SetDefault ("ns3::PointToPointNetDevice::DataRate", StringValue ("1Mbps"));
+  Config::SetDefault ("ns3::PointToPointChannel::Delay", StringValue ("10ms"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("20"));
+
+  RankingParameters params;
+  params.consumerPopulation = true;
+  params.contentStore = "ns3::ndn::cs::RankingTable";
+  params.iterations = 1;
+
+  std::string topologies = "dfn,att";
+  std::string consumersPerEdge = "1,10,100";
+  std::string sketches = "16x4,64x8,256x16";
+
+  CommandLine cmd;
+  params.AddCommandLineArguments (cmd);
+  cmd.AddValue ("topologies", "Comma-separated topologies (see RankingTopology::Get)", topologies);
+  cmd.AddValue ("consumersPerEdge", "Comma-separated numbers of consumers attached to each edge router", consumersPerEdge);
+  cmd.AddValue ("sketches", "Comma-separated sketch geometries, FaceSketchRegisters x FaceSketchWidth", sketches);
+  cmd.Parse (argc, argv);
+
+  // Exact accounting in the caches, the reference of the sketches
+  Config::SetDefault ("ns3::ndn::cs::RankingTable::ExclusionAccounting", StringValue ("exact"));
+  // Sinks only see iterations run in this process
+  params.snapshot = false;
+
+  std::vector<std::string> geometries = ParseList (sketches);
+  for (uint32_t g = 0; g < geometries.size (); g++)
+    {
+      uint32_t registers = 0;
+      uint32_t width = 0;
+      if (sscanf (geometries[g].c_str (), "%ux%u", &registers, &width) != 2)
+	NS_FATAL_ERROR ("Invalid sketch geometry [" << geometries[g] << "], expected <registers>x<width>");
+      g_sketches.push_back (FaceSketch (registers, width));
+    }
+
+  std::cout << "--------------------------------------------------------------------------------------------------------------" << std::endl;
+  std::cout << "  Topology   Consumers   Exclusions   Faces (max)    Accounting   bytes/version   faces err (mean/max)   count over" << std::endl;
+  std::cout << "--------------------------------------------------------------------------------------------------------------" << std::endl;
+
+  std::vector<std::string> topologyNames = ParseList (topologies);
+  std::vector<std::string> consumerCounts = ParseList (consumersPerEdge);
+  for (std::vector<std::string>::const_iterator topologyName = topologyNames.begin (); topologyName != topologyNames.end (); topologyName++)
+    {
+      for (std::vector<std::string>::const_iterator consumers = consumerCounts.begin (); consumers != consumerCounts.end (); consumers++)
+	{
+	  RankingParameters point = params;
+	  point.topology = *topologyName;
+	  point.consumersPerEdge = atoi (consumers->c_str ());
+
+	  g_accuracy.assign (g_sketches.size (), Accuracy ());
+	  g_shadows.clear ();
+	  g_exclusions = 0;
+	  g_maxFaces = 0;
+
+	  RankingScenario scenario (point);
+	  scenario.SetBuiltCallback (MakeCallback (&ConnectCaches));
+	  RankingResults results (point);
+	  scenario.Run (results);
+
+	  uint64_t versions = 0;
+	  uint64_t exactBytes = 0;
+	  for (std::list<Shadow>::const_iterator shadow = g_shadows.begin (); shadow != g_shadows.end (); shadow++)
+	    {
+	      versions += shadow->size;
+	      exactBytes += shadow->peakBytes;
+	    }
+	  g_shadows.clear ();
+
+	  std::cout << std::fixed << std::setprecision (2);
+	  for (uint32_t g = 0; g <= g_sketches.size (); g++)
+	    {
+	      std::cout << std::setw (10) << *topologyName;
+	      std::cout << std::setw (12) << point.consumersPerEdge;
+	      std::cout << std::setw (13) << g_exclusions;
+	      std::cout << std::setw (14) << g_maxFaces;
+	      if (g == 0)
+		{
+		  std::cout << std::setw (14) << "exact";
+		  std::cout << std::setw (16) << (double)exactBytes / std::max<uint64_t> (versions, 1);
+		  std::cout << std::setw (23) << "-";
+		  std::cout << std::setw (13) << "-";
+		}
+	      else
+		{
+		  const Accuracy &a = g_accuracy[g - 1];
+		  std::ostringstream face_error;
+		  face_error << std::fixed << std::setprecision (1) << 100 * a.faceError / std::max<uint64_t> (a.samples, 1)
+			     << "% / " << 100 * a.maxFaceError << "%";
+		  std::cout << std::setw (14) << geometries[g - 1];
+		  std::cout << std::setw (16) << (double)g_sketches[g - 1].GetBytes ();
+		  std::cout << std::setw (23) << face_error.str ();
+		  std::cout << std::setw (13) << a.overestimate / std::max<uint64_t> (a.samples, 1);
+		}
+	      std::cout << std::endl;
+	    }
+	}
+    }
+  std::cout << "--------------------------------------------------------------------------------------------------------------" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/ndnSIM-module.h"
+
+#include "ranking-sweep.h"
+
+using namespace ns3;
+
+// Parameterized replacement of the populated-cache scenarios in scenarios/NDSS and
+// scenarios/SENT, e.g.
+//
+//   dfn-fresh-populateIN-bc0.95-bCr0.2-hist-WR:
+//     ./build/ranking --cachePlacement=in --badConsumerRate=0.2
+//
+//   att-fresh-populate-stop-bc1.99-bCr0.05-CDF-WR:
+//     ./build/ranking --topology=att --consumersPerEdge=10 --badConsumerRate=0.05
+//                     --goodContentTimeout=400 --populatedContentCount=100 --goodContentCount=1
+//                     --frequency=5 --randomize=uniform --iterations=50 --output=cdf
+//
+//   dfn-fresh-populate-bc0.95-bCr{0.0..1.0}-hist-WR, in one table:
+//     ./build/ranking --sweep="badConsumerRate=0:0.1:1" --workers=0
+int 
+main (int argc, char *argv[])
+{
+  // setting default parameters for PointToPoint links and channels
+  Config::SetDefault ("ns3::PointToPointNetDevice::DataRate", StringValue ("1Mbps"));
+  Config::SetDefault ("ns3::PointToPointChannel::Delay", StringValue ("10ms"));
+  Config::SetDefault ("ns3::DropTailQueue::MaxPackets", StringValue ("20"));
+
+  RankingParameters params;
+  std::string sweep;
+
+  // Read optional command-line parameters (e.g., enable visualizer with ./waf --run=<> --visualize
+  CommandLine cmd;
+  params.AddCommandLineArguments (cmd);
+  cmd.AddValue ("sweep", "Parameter grid, e.g. \"badConsumerRate=0:0.1:1;disableRanking=false,true\"", sweep);
+  cmd.Parse (argc, argv);
+
+  if (!sweep.empty ())
+    {
+      // Grid points are spread over --workers processes
+      RankingSweep (params, sweep).Run (std::cout);
+      return 0;
+    }
+
+  // Iterations are spread over --workers processes, and stop early with --confidenceHalfWidth
+  RankingExecutor executor (params);
+  RankingResults results (params);
+  executor.Run (results);
+  results.Print (std::cout, params);
+  results.PrintTiming (std::cerr);
+  if (params.confidenceHalfWidth > 0)
+    results.PrintConvergence (std::cerr, params);
+
+  return 0;
+}